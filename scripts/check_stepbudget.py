@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""
+Check that seeded parallel ACS runs (alg 2) give the same result whether the
+solve runs on its own threads or is sliced with --stepbudget.
+
+Example:
+    python scripts/check_stepbudget.py --budgets 1 3 5 7 64
+"""
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import sys
+from pathlib import Path
+from subprocess import run, PIPE
+from typing import List, Sequence
+
+# Fields that depend on the wall clock rather than on the search
+TIMING_FIELDS = ("time", "cp_initial", "cp_ant_avg", "cp_ant_total", "cp_total")
+
+DEFAULT_CASES = (
+    ["--blank", "--order", "3", "--subcolonies", "8", "--seed", "1"],
+    ["--blank", "--order", "4", "--subcolonies", "4", "--seed", "2"],
+    ["--blank", "--order", "4", "--subcolonies", "8", "--seed", "5"],
+    ["--blank", "--order", "3", "--subcolonies", "3", "--seed", "7", "--variant", "mmas"],
+    ["--file", "hard/9x9hard_1", "--subcolonies", "4", "--seed", "3", "--maxiters", "300"],
+    ["--file", "hard/9x9hard_4", "--subcolonies", "6", "--seed", "4", "--maxiters", "300"],
+)
+
+
+def find_repo_root() -> Path:
+    return Path(__file__).resolve().parents[1]
+
+
+def resolve_solver_path(user_value: str | None) -> Path:
+    repo_root = find_repo_root()
+    candidates = [user_value] if user_value else ["sudokusolver", "sudokusolver.exe",
+                                                  os.path.join("vs2017", "x64", "Release", "sudoku_ants.exe")]
+    for candidate in candidates:
+        path = Path(candidate)
+        if not path.is_absolute():
+            path = (repo_root / path).resolve()
+        if path.exists() and path.is_file():
+            return path
+    raise FileNotFoundError("Solver binary not found. Build it first (e.g. run `make`).")
+
+
+def solve(solver: Path, args: Sequence[str]) -> dict:
+    result = run([str(solver), *args, "--alg", "2", "--json"], stdout=PIPE, stderr=PIPE,
+                 universal_newlines=True, cwd=str(find_repo_root()))
+    output = json.loads(result.stdout)
+    for field in TIMING_FIELDS:
+        output.pop(field, None)
+    return output
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Compare threaded and sliced seeded parallel ACS runs.")
+    parser.add_argument("--solver", default=None, help="Path to the solver executable (default: auto-detect)")
+    parser.add_argument("--budgets", type=int, nargs="+", default=[1, 3, 5, 7, 64],
+                        help="Colony iterations per Step() call to compare against the threaded run.")
+    args = parser.parse_args()
+
+    solver = resolve_solver_path(args.solver)
+    failures: List[str] = []
+    for case in DEFAULT_CASES:
+        threaded = solve(solver, case)
+        for budget in args.budgets:
+            sliced = solve(solver, [*case, "--stepbudget", str(budget)])
+            if sliced != threaded:
+                failures.append(f"{' '.join(case)} --stepbudget {budget}")
+                print(f"DIFF  {failures[-1]}")
+    runs = len(DEFAULT_CASES) * len(args.budgets)
+    print(f"{runs - len(failures)}/{runs} sliced runs match the threaded run")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
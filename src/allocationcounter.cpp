@@ -0,0 +1,41 @@
+/*******************************************************************************
+ * ALLOCATION COUNTER - Implementation
+ ******************************************************************************/
+
+#include "allocationcounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<long long> allocationCount(0);
+
+bool AllocationCountEnabled()
+{
+#ifdef COUNT_ALLOCATIONS
+	return true;
+#else
+	return false;
+#endif
+}
+
+long long AllocationCount()
+{
+	return allocationCount.load();
+}
+
+#ifdef COUNT_ALLOCATIONS
+// the array and nothrow forms forward to these two by default
+void* operator new(std::size_t size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	void *p = std::malloc(size == 0 ? 1 : size);
+	if (p == nullptr)
+		throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void *p) noexcept
+{
+	std::free(p);
+}
+#endif
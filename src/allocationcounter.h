@@ -0,0 +1,16 @@
+#pragma once
+/*******************************************************************************
+ * ALLOCATION COUNTER - Heap allocation count for steady-state checks
+ *
+ * When built with -DCOUNT_ALLOCATIONS (make COUNT_ALLOCATIONS=1) the global
+ * operator new is replaced by a version that counts every call, so that a
+ * check can assert that solver iterations do not allocate once the solver's
+ * buffers are sized (see --alloccheck). Without the flag nothing is replaced
+ * and the count stays at zero.
+ ******************************************************************************/
+
+// true if the allocation counter is compiled in
+bool AllocationCountEnabled();
+
+// number of heap allocations since program start (all threads)
+long long AllocationCount();
@@ -9,7 +9,10 @@ public:
 	virtual float Getq0() = 0;
 	virtual float random() = 0;
 	virtual float Pher(int i, int j) = 0;
-	virtual void LocalPheromoneUpdate(int iCell, int iChoice) = 0;
+	// pheromone matrix and tau0, for the local update of the ants' policy
+	// (see pheromonepolicy.h); read once per construction
+	virtual float **PherMatrix() = 0;
+	virtual float Pher0() = 0;
 };
 
 
@@ -0,0 +1,51 @@
+/*******************************************************************************
+ * ANT COUNT CONTROLLER - Implementation
+ ******************************************************************************/
+
+#include "antcount.h"
+#include <algorithm>
+
+const float AntCountController::rateWeight = 0.1f;
+const float AntCountController::growRate = 0.2f;
+const float AntCountController::shrinkRate = 0.05f;
+
+void AntCountController::Configure(int newMinAnts, float newMaxIterationTime)
+{
+	minAnts = newMinAnts;
+	maxIterationTime = newMaxIterationTime;
+}
+
+void AntCountController::Reset(int numAnts, int initialScore)
+{
+	maxAnts = numAnts;
+	active = numAnts;
+	bestScore = initialScore;
+	// a fresh colony counts as improving, so it starts with the whole population
+	improvementRate = growRate;
+	antIterations = 0;
+	iterations = 0;
+}
+
+void AntCountController::Update(int iterationBestScore, float iterationTime)
+{
+	antIterations += active;
+	++iterations;
+	if (!Enabled())
+		return;
+	bool improved = iterationBestScore > bestScore;
+	if (improved)
+		bestScore = iterationBestScore;
+	improvementRate += rateWeight * ((improved ? 1.0f : 0.0f) - improvementRate);
+
+	int step = std::max(1, active / 4);
+	bool tooSlow = maxIterationTime > 0.0f && iterationTime > maxIterationTime;
+	if (tooSlow || improvementRate < shrinkRate)
+		active = std::max(minAnts, active - step);
+	else if (improvementRate >= growRate && active < maxAnts)
+	{
+		int grown = std::min(maxAnts, active + step);
+		// the iteration time grows about linearly with the ants
+		if (maxIterationTime <= 0.0f || iterationTime * grown / active <= maxIterationTime)
+			active = grown;
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+/*******************************************************************************
+ * ANT COUNT CONTROLLER - Adaptive number of ants per iteration
+ *
+ * The colony allocates maxAnts ants once and runs the first active ones of
+ * them each iteration, so changing the count allocates nothing. The count
+ * starts at maxAnts: early iterations, where many cheap ants still find
+ * better solutions, use the whole population. After every iteration the
+ * controller updates a running average of how often the iteration-best
+ * improved on the best score so far and
+ * - shrinks the count by a quarter (at least one ant, not below minAnts) when
+ *   the iteration took longer than maxIterationTime, or once the improvement
+ *   rate has fallen below shrinkRate, so a stalled colony runs more, cheaper
+ *   iterations and so more pheromone updates per second
+ * - grows it by a quarter (not above maxAnts) while the improvement rate is
+ *   at least growRate and the larger iteration is expected to fit in
+ *   maxIterationTime
+ *
+ * With maxIterationTime 0 the count depends only on the scores, so seeded
+ * runs stay reproducible.
+ ******************************************************************************/
+
+class AntCountController
+{
+	int minAnts;				// 0 = off (fixed count)
+	int maxAnts;
+	float maxIterationTime;		// seconds, 0 = no limit
+	float improvementRate;		// running average of improving iterations
+	int bestScore;
+	int active;
+	long long antIterations;	// sum of the active counts of all iterations
+	int iterations;
+
+	static const float rateWeight;	// weight of the latest iteration in improvementRate
+	static const float growRate;
+	static const float shrinkRate;
+
+public:
+	AntCountController() : minAnts(0), maxAnts(0), maxIterationTime(0.0f), improvementRate(0.0f),
+		bestScore(0), active(0), antIterations(0), iterations(0) {}
+
+	// adapt between minAnts and the allocated ants (0 = off)
+	void Configure(int minAnts, float maxIterationTime);
+	bool Enabled() const { return minAnts > 0 && minAnts < maxAnts; }
+	// start of a solve with numAnts ants allocated
+	void Reset(int numAnts, int initialScore);
+
+	// ants to run in the next iteration
+	int Active() const { return active; }
+	// record one iteration (run with Active() ants); updates Active()
+	void Update(int iterationBestScore, float iterationTime);
+
+	// mean ant count over the iterations of the solve
+	float MeanAnts() const { return iterations > 0 ? (float)antIterations / iterations : (float)active; }
+};
@@ -0,0 +1,476 @@
+/*******************************************************************************
+ * ANT POPULATION - Implementation
+ ******************************************************************************/
+
+#include "antpopulation.h"
+#include "constraintpropagation.h"
+#include "pheromonepolicy.h"
+#include <algorithm>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+void AntPopulation::Reset(int newNumAnts, int order, AntEngine engine)
+{
+	int newNumUnits = order * order;
+	numAnts = newNumAnts;
+	active = numAnts;
+	useGrid16 = (engine == ANT_ENGINE_GRID16) && Grid16::Supports(order);
+	useLanes = (engine == ANT_ENGINE_LANES);
+	if (newNumUnits != numUnits)
+	{
+		numUnits = newNumUnits;
+		numCells = numUnits * numUnits;
+		mask = (numUnits == 64) ? ~(uint64_t)0 : (((uint64_t)1 << numUnits) - 1);
+
+		// same cell order within units as Board::RowCell/ColCell/BoxCell, so
+		// propagation visits cells in the order of constraintpropagation.cpp
+		rowCells.resize(numCells);
+		colCells.resize(numCells);
+		boxCells.resize(numCells);
+		rowOf.resize(numCells);
+		colOf.resize(numCells);
+		boxOf.resize(numCells);
+		for (int u = 0; u < numUnits; u++)
+		{
+			int topCorner = (u % order) * order + (u / order) * order * order * order;
+			for (int j = 0; j < numUnits; j++)
+			{
+				rowCells[u * numUnits + j] = u * numUnits + j;
+				colCells[u * numUnits + j] = j * numUnits + u;
+				boxCells[u * numUnits + j] = topCorner + (j % order) + (j / order) * order * order;
+			}
+		}
+		for (int i = 0; i < numCells; i++)
+		{
+			rowOf[i] = i / numUnits;
+			colOf[i] = i % numUnits;
+			boxOf[i] = order * (i / (order * order * order)) + (i % (order * order)) / order;
+		}
+	}
+	if (useGrid16)
+	{
+		if ((int)grids.size() < numAnts)
+			grids.resize(numAnts);
+	}
+	else if (cand.size() < (size_t)numAnts * numCells)
+		cand.resize((size_t)numAnts * numCells);
+	if ((int)cursor.size() < numAnts)
+	{
+		cursor.resize(numAnts);
+		failCells.resize(numAnts);
+		fixedCount.resize(numAnts);
+		infeasibleCount.resize(numAnts);
+		choose.resize(numAnts);
+	}
+	if ((int)roulette.size() < numUnits)
+	{
+		roulette.resize(numUnits);
+		rouletteVals.resize(numUnits);
+	}
+	if (useLanes)
+	{
+		if ((int)laneAnts.size() < numAnts)
+		{
+			laneAnts.resize(numAnts);
+			laneGreedy.resize(numAnts);
+			laneRandom.resize(numAnts);
+			laneValues.resize(numAnts);
+		}
+		if ((int)pherTile.size() < numUnits * numLanes)
+		{
+			pherTile.resize(numUnits * numLanes);
+			candTile.resize(numUnits * numLanes);
+		}
+	}
+}
+
+// Set cell of ant to value and propagate to its row, column and box peers
+// (SetCellAndPropagate)
+void AntPopulation::SetAndPropagate(int ant, int cell, uint64_t value)
+{
+	if (IsFixed(Cell(ant, cell)))
+		return;
+	Cell(ant, cell) = value;
+	fixedCount[ant]++;
+	cpCalls++;
+
+	const int *box = &boxCells[boxOf[cell] * numUnits];
+	const int *col = &colCells[colOf[cell] * numUnits];
+	const int *row = &rowCells[rowOf[cell] * numUnits];
+	for (int j = 0; j < numUnits; j++)
+	{
+		if (box[j] != cell)
+			Propagate(ant, box[j]);
+		if (col[j] != cell)
+			Propagate(ant, col[j]);
+		if (row[j] != cell)
+			Propagate(ant, row[j]);
+	}
+}
+
+// Elimination then hidden single on one cell of ant (PropagateConstraints)
+void AntPopulation::Propagate(int ant, int cell)
+{
+	uint64_t x = Cell(ant, cell);
+	if (x == 0 || IsFixed(x))
+		return;
+
+	const int *box = &boxCells[boxOf[cell] * numUnits];
+	const int *col = &colCells[colOf[cell] * numUnits];
+	const int *row = &rowCells[rowOf[cell] * numUnits];
+
+	// Rule 1: elimination of the values fixed in the peers
+	uint64_t fixedPeers = 0;
+	for (int j = 0; j < numUnits; j++)
+	{
+		uint64_t v;
+		if (box[j] != cell && IsFixed(v = Cell(ant, box[j])))
+			fixedPeers |= v;
+		if (col[j] != cell && IsFixed(v = Cell(ant, col[j])))
+			fixedPeers |= v;
+		if (row[j] != cell && IsFixed(v = Cell(ant, row[j])))
+			fixedPeers |= v;
+	}
+	uint64_t allowed = mask & ~fixedPeers;
+	if (IsFixed(allowed))
+	{
+		SetAndPropagate(ant, cell, allowed);
+		return;
+	}
+	x &= allowed;
+	Cell(ant, cell) = x;
+
+	// Rule 2: hidden single in the row, column or box
+	if (x != 0 && !IsFixed(x))
+	{
+		uint64_t boxAll = 0, colAll = 0, rowAll = 0;
+		for (int j = 0; j < numUnits; j++)
+		{
+			if (box[j] != cell)
+				boxAll |= Cell(ant, box[j]);
+			if (col[j] != cell)
+				colAll |= Cell(ant, col[j]);
+			if (row[j] != cell)
+				rowAll |= Cell(ant, row[j]);
+		}
+		if (IsFixed(x & ~rowAll))
+			SetAndPropagate(ant, cell, x & ~rowAll);
+		else if (IsFixed(x & ~colAll))
+			SetAndPropagate(ant, cell, x & ~colAll);
+		else if (IsFixed(x & ~boxAll))
+			SetAndPropagate(ant, cell, x & ~boxAll);
+	}
+
+	if (Cell(ant, cell) == 0)
+		infeasibleCount[ant]++;
+}
+
+uint64_t ChooseAntValue(IAntColony *parent, int cell, uint64_t x, int numUnits, float *roulette, uint64_t *rouletteVals)
+{
+	if (parent->random() < parent->Getq0())
+	{
+		// greedy selection
+		uint64_t best = 0;
+		float maxPher = -1.0f;
+		for (int i = 0; i < numUnits; i++)
+		{
+			if ((x >> i) & 1)
+			{
+				float p = parent->Pher(cell, i);
+				if (p > maxPher)
+				{
+					maxPher = p;
+					best = (uint64_t)1 << i;
+				}
+			}
+		}
+		return best;
+	}
+	// weighted selection
+	float totPher = 0.0f;
+	int numChoices = 0;
+	for (int i = 0; i < numUnits; i++)
+	{
+		if ((x >> i) & 1)
+		{
+			roulette[numChoices] = totPher + parent->Pher(cell, i);
+			totPher = roulette[numChoices];
+			rouletteVals[numChoices] = (uint64_t)1 << i;
+			++numChoices;
+		}
+	}
+	float rouletteVal = totPher * parent->random();
+	for (int i = 0; i < numChoices; i++)
+	{
+		if (roulette[i] > rouletteVal)
+			return rouletteVals[i];
+	}
+	return 0;
+}
+
+// ACS choice of a value for cell of ant (SudokuAnt::FillCell)
+template<class Policy>
+void AntPopulation::Choose(int ant, int cell)
+{
+	uint64_t value = ChooseAntValue(parent, cell, Cell(ant, cell), numUnits, roulette.data(), rouletteVals.data());
+	if (value != 0)
+	{
+		SetAndPropagate(ant, cell, value);
+		Policy::LocalUpdate(pher[cell][ValueSet(numUnits, value).Index()], pher0);
+	}
+}
+
+// The choices of the open ants of a step across ants (ANT_ENGINE_LANES): the
+// random numbers are drawn in ant order as by ChooseAntValue (the roulette
+// number only for a roulette choice), the values are chosen numLanes ants at
+// a time against the pheromone of the start of the step, then the cascades
+// and local updates follow in ant order
+template<class Policy>
+void AntPopulation::ChooseAcross()
+{
+	int n = 0;
+	float q0 = parent->Getq0();
+	for (int a = 0; a < active; a++)
+	{
+		if (!choose[a])
+			continue;
+		laneAnts[n] = a;
+		laneGreedy[n] = parent->random() < q0;
+		laneRandom[n] = laneGreedy[n] ? 0.0f : parent->random();
+		n++;
+	}
+	for (int k = 0; k < n; k += numLanes)
+		ChooseBatch(k, (n - k < numLanes) ? n - k : numLanes);
+	for (int k = 0; k < n; k++)
+	{
+		uint64_t value = laneValues[k];
+		if (value != 0)
+		{
+			int a = laneAnts[k], cell = cursor[a];
+			SetAndPropagate(a, cell, value);
+			Policy::LocalUpdate(pher[cell][ValueSet(numUnits, value).Index()], pher0);
+		}
+	}
+}
+
+// ChooseAntValue for the lanes (<= numLanes) open ants from laneAnts[first]
+// on: the pheromone of each ant's cell is gathered into the lane-major tile,
+// masked by its candidates, then one pass over the values keeps the greedy
+// maximum and the roulette total of every lane and a second pass finds the
+// roulette pick. The sums run in value order, as in ChooseAntValue, so each
+// lane makes the choice ChooseAntValue would make with the same pheromone.
+void AntPopulation::ChooseBatch(int first, int lanes)
+{
+	const int *ants = &laneAnts[first];
+	float random[numLanes];
+	uint32_t greedy[numLanes];
+	for (int l = 0; l < numLanes; l++)
+	{
+		uint64_t x = 0;
+		const float *row = nullptr;
+		if (l < lanes)
+		{
+			x = Cell(ants[l], cursor[ants[l]]);
+			row = pher[cursor[ants[l]]];
+		}
+		for (int i = 0; i < numUnits; i++)
+		{
+			bool candidate = (x >> i) & 1;
+			pherTile[i * numLanes + l] = candidate ? row[i] : 0.0f;
+			candTile[i * numLanes + l] = candidate ? ~0u : 0u;
+		}
+		// unused lanes count as greedy, which ends the roulette pass early
+		greedy[l] = (l >= lanes || laneGreedy[first + l]) ? ~0u : 0u;
+		random[l] = (l < lanes) ? laneRandom[first + l] : 0.0f;
+	}
+
+	int best[numLanes], pick[numLanes];
+#ifdef __AVX2__
+	__m256 total = _mm256_setzero_ps();
+	__m256 maxPher = _mm256_set1_ps(-1.0f);
+	__m256 bestIndex = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+	for (int i = 0; i < numUnits; i++)
+	{
+		__m256 p = _mm256_loadu_ps(&pherTile[i * numLanes]);
+		__m256 candidate = _mm256_loadu_ps((const float*)&candTile[i * numLanes]);
+		total = _mm256_add_ps(total, p);
+		__m256 better = _mm256_and_ps(candidate, _mm256_cmp_ps(p, maxPher, _CMP_GT_OQ));
+		maxPher = _mm256_blendv_ps(maxPher, p, better);
+		bestIndex = _mm256_blendv_ps(bestIndex, _mm256_castsi256_ps(_mm256_set1_epi32(i)), better);
+	}
+	__m256 threshold = _mm256_mul_ps(total, _mm256_loadu_ps(random));
+	__m256 done = _mm256_loadu_ps((const float*)greedy);
+	__m256 sum = _mm256_setzero_ps();
+	__m256 pickIndex = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+	for (int i = 0; i < numUnits && _mm256_movemask_ps(done) != 0xFF; i++)
+	{
+		__m256 p = _mm256_loadu_ps(&pherTile[i * numLanes]);
+		__m256 candidate = _mm256_loadu_ps((const float*)&candTile[i * numLanes]);
+		sum = _mm256_add_ps(sum, p);
+		__m256 hit = _mm256_andnot_ps(done, _mm256_and_ps(candidate, _mm256_cmp_ps(sum, threshold, _CMP_GT_OQ)));
+		pickIndex = _mm256_blendv_ps(pickIndex, _mm256_castsi256_ps(_mm256_set1_epi32(i)), hit);
+		done = _mm256_or_ps(done, hit);
+	}
+	_mm256_storeu_si256((__m256i*)best, _mm256_castps_si256(bestIndex));
+	_mm256_storeu_si256((__m256i*)pick, _mm256_castps_si256(pickIndex));
+#else
+	float total[numLanes], maxPher[numLanes], sum[numLanes], threshold[numLanes];
+	for (int l = 0; l < numLanes; l++)
+	{
+		total[l] = 0.0f;
+		maxPher[l] = -1.0f;
+		sum[l] = 0.0f;
+		best[l] = pick[l] = -1;
+	}
+	for (int i = 0; i < numUnits; i++)
+	{
+		const float *p = &pherTile[i * numLanes];
+		const uint32_t *candidate = &candTile[i * numLanes];
+		for (int l = 0; l < numLanes; l++)
+		{
+			total[l] += p[l];
+			if (candidate[l] && p[l] > maxPher[l])
+			{
+				maxPher[l] = p[l];
+				best[l] = i;
+			}
+		}
+	}
+	for (int l = 0; l < numLanes; l++)
+		threshold[l] = total[l] * random[l];
+	for (int i = 0; i < numUnits; i++)
+	{
+		const float *p = &pherTile[i * numLanes];
+		const uint32_t *candidate = &candTile[i * numLanes];
+		for (int l = 0; l < numLanes; l++)
+		{
+			sum[l] += p[l];
+			if (candidate[l] && !greedy[l] && pick[l] < 0 && sum[l] > threshold[l])
+				pick[l] = i;
+		}
+	}
+#endif
+	for (int l = 0; l < lanes; l++)
+	{
+		int index = laneGreedy[first + l] ? best[l] : pick[l];
+		laneValues[first + l] = (index < 0) ? 0 : (uint64_t)1 << index;
+	}
+}
+
+/*******************************************************************************
+ * Construct
+ *
+ * Every step classifies the current cell of all ants (empty, fixed or open)
+ * in one pass over the ants, makes the choices of the open ants in ant
+ * order (or across ants, ChooseAcross), then advances all cursors.
+ ******************************************************************************/
+template<class Policy>
+void AntPopulation::Construct(const Board& puzzle, const int *startCells)
+{
+	pher = parent->PherMatrix();
+	pher0 = parent->Pher0();
+	if (useGrid16)
+	{
+		ConstructGrid16<Policy>(puzzle, startCells);
+		return;
+	}
+	for (int i = 0; i < numCells; i++)
+		cand[i] = puzzle.GetCell(i).GetBits();
+	for (int a = 1; a < active; a++)
+		std::copy(cand.begin(), cand.begin() + numCells, cand.begin() + (size_t)a * numCells);
+	int puzzleFixed = puzzle.FixedCellCount();
+	int puzzleInfeasible = puzzle.InfeasibleCellCount();
+	for (int a = 0; a < active; a++)
+	{
+		cursor[a] = startCells[a];
+		failCells[a] = 0;
+		fixedCount[a] = puzzleFixed;
+		infeasibleCount[a] = puzzleInfeasible;
+	}
+	cpCalls = 0;
+
+	for (int step = 0; step < numCells; step++)
+	{
+		for (int a = 0; a < active; a++)
+		{
+			uint64_t x = Cell(a, cursor[a]);
+			failCells[a] += (x == 0);
+			choose[a] = (x != 0) && (x & (x - 1)) != 0;
+		}
+		if (useLanes)
+			ChooseAcross<Policy>();
+		else
+		{
+			for (int a = 0; a < active; a++)
+			{
+				if (choose[a])
+					Choose<Policy>(a, cursor[a]);
+			}
+		}
+		for (int a = 0; a < active; a++)
+			cursor[a] = (cursor[a] + 1 == numCells) ? 0 : cursor[a] + 1;
+	}
+	AddAntCPCalls(cpCalls);
+}
+
+// Construct with one Grid16 per ant, stepping the ants in the same order
+template<class Policy>
+void AntPopulation::ConstructGrid16(const Board& puzzle, const int *startCells)
+{
+	grids[0].FromBoard(puzzle);
+	for (int a = 0; a < active; a++)
+	{
+		if (a > 0)
+			grids[a] = grids[0];
+		cursor[a] = startCells[a];
+		failCells[a] = 0;
+	}
+
+	for (int step = 0; step < numCells; step++)
+	{
+		for (int a = 0; a < active; a++)
+		{
+			Grid16 &grid = grids[a];
+			int cell = cursor[a];
+			uint16_t x = grid.Candidates(cell);
+			if (x == 0)
+				failCells[a]++;
+			else if (!Grid16::IsFixed(x))
+			{
+				uint64_t value = ChooseAntValue(parent, cell, x, numUnits, roulette.data(), rouletteVals.data());
+				if (value != 0)
+				{
+					grid.SetCellAndPropagate(cell, (uint16_t)value);
+					Policy::LocalUpdate(pher[cell][ValueSet(numUnits, value).Index()], pher0);
+				}
+			}
+			cursor[a] = (cell + 1 == numCells) ? 0 : cell + 1;
+		}
+	}
+	int calls = 0;
+	for (int a = 0; a < active; a++)
+		calls += grids[a].CPCalls();
+	AddAntCPCalls(calls);
+}
+
+void AntPopulation::ExportSolution(int ant, const Board& puzzle, Board& out)
+{
+	if (useGrid16)
+	{
+		grids[ant].ToBoard(puzzle, out);
+		return;
+	}
+	out.Copy(puzzle);
+	for (int i = 0; i < numCells; i++)
+		out.SetCellDirect(i, ValueSet(numUnits, Cell(ant, i)));
+	for (int k = puzzle.FixedCellCount(); k < fixedCount[ant]; k++)
+		out.IncrementFixedCells();
+	for (int k = puzzle.InfeasibleCellCount(); k < infeasibleCount[ant]; k++)
+		out.IncrementInfeasible();
+}
+
+template void AntPopulation::Construct<ACSPolicy>(const Board& puzzle, const int *startCells);
+template void AntPopulation::Construct<MMASPolicy>(const Board& puzzle, const int *startCells);
+template void AntPopulation::Construct<IterationBestPolicy>(const Board& puzzle, const int *startCells);
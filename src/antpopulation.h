@@ -0,0 +1,145 @@
+#pragma once
+/*******************************************************************************
+ * ANT POPULATION - Ant population construction engine (--antengine population)
+ *
+ * Alternative to one SudokuAnt object (with its own Board) per ant for the
+ * construction phase. All ants of a colony live in one population: their
+ * candidate bitmaps are in one flat array, ant-major (cand[ant * numCells +
+ * cell]), so the propagation cascade of one ant, which is most of the work,
+ * stays within that ant's own block of memory. Each step the current cell of
+ * every ant is classified (empty, fixed or open) in one loop over the ants
+ * before the open ants choose.
+ *
+ * The choice of each ant follows the ACS rules of SudokuAnt, in ant order,
+ * and consumes the colony's random numbers in the same order; the local
+ * pheromone update of one ant is seen by the next ones, as in the scalar
+ * engine. The choices are therefore made one ant at a time, not across ants
+ * in parallel. Propagation cascades are handled per ant with the elimination
+ * and hidden single rules of constraintpropagation.cpp, on precomputed unit
+ * tables and without the per-rule timing. With the same random sequence both
+ * engines build the same solutions. Only the sequential cell order is
+ * supported.
+ *
+ * With --antengine grid16 on 16x16 puzzles each ant gets a Grid16 instead
+ * (uint16_t cells, the unit reductions of the cascade as AVX2 kernels);
+ * choices and cascades are the same. Other orders use the population engine.
+ *
+ * With --antengine lanes the choices of a step are made across ants, 8 at a
+ * time (one AVX2 register of floats): the random numbers of the open ants
+ * are drawn in ant order, the pheromone of each ant's cell is gathered into
+ * a lane-major tile masked by its candidates, and one pass over the values
+ * finds the greedy maximum and the roulette total of every lane, a second
+ * one the roulette pick. The cascades then run per ant as above, followed by
+ * the local pheromone updates of the step, in ant order. All ants of a step
+ * therefore see the pheromone as it was at the start of the step: under ACS
+ * and iteration-best the result differs from the other engines, while under
+ * MMAS (no local update) it is the same.
+ ******************************************************************************/
+
+#include "board.h"
+#include "antcolonyinterface.h"
+#include "grid16.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Construction engine of the ant systems
+enum AntEngine
+{
+	ANT_ENGINE_SCALAR,	// one SudokuAnt per ant
+	ANT_ENGINE_POPULATION,	// AntPopulation
+	ANT_ENGINE_GRID16,	// AntPopulation on Grid16s for 16x16 puzzles
+	ANT_ENGINE_LANES	// AntPopulation choosing across ants (deferred local update)
+};
+
+// Parse an --antengine value (scalar, population, grid16 or lanes)
+inline AntEngine ParseAntEngine(const std::string& name)
+{
+	if (name == "population")
+		return ANT_ENGINE_POPULATION;
+	if (name == "grid16")
+		return ANT_ENGINE_GRID16;
+	if (name == "lanes")
+		return ANT_ENGINE_LANES;
+	return ANT_ENGINE_SCALAR;
+}
+
+// ACS choice of SudokuAnt::FillCell among the candidates x of cell: the value
+// (one bit) to set, or 0 if the roulette picked none. roulette and
+// rouletteVals hold numUnits entries.
+uint64_t ChooseAntValue(IAntColony *parent, int cell, uint64_t x, int numUnits, float *roulette, uint64_t *rouletteVals);
+
+class AntPopulation
+{
+	IAntColony *parent;
+	int numAnts;
+	int active;		// ants run by Construct (SetActive)
+	int numUnits;
+	int numCells;
+	uint64_t mask;	// all values
+
+	std::vector<uint64_t> cand;		// candidates, cand[ant * numCells + cell]
+	std::vector<int> cursor;		// next cell of each ant
+	std::vector<int> failCells;		// cells found empty by each ant
+	std::vector<int> fixedCount;	// fixed cell counter of each ant's board
+	std::vector<int> infeasibleCount;	// infeasible counter of each ant's board
+	std::vector<uint8_t> choose;	// ant has to choose a value this step
+
+	// unit tables: cells of each row, column and box, and the units of each cell
+	std::vector<int> rowCells, colCells, boxCells;
+	std::vector<int> rowOf, colOf, boxOf;
+
+	bool useGrid16;				// ants are grids (ANT_ENGINE_GRID16, order 4)
+	std::vector<Grid16> grids;	// board of each ant when useGrid16
+
+	// choices across ants (ANT_ENGINE_LANES): the open ants of a step, their
+	// draws and values, and the lane-major tile of one batch
+	bool useLanes;
+	std::vector<int> laneAnts;
+	std::vector<uint8_t> laneGreedy;
+	std::vector<float> laneRandom;
+	std::vector<uint64_t> laneValues;
+	std::vector<float> pherTile;		// pherTile[value * numLanes + lane], 0 if not a candidate
+	std::vector<uint32_t> candTile;		// all ones where the value is a candidate
+
+	std::vector<float> roulette;
+	std::vector<uint64_t> rouletteVals;
+	int cpCalls;
+	float **pher;	// parent's pheromone matrix (set by Construct)
+	float pher0;
+
+	uint64_t& Cell(int ant, int cell) { return cand[(size_t)ant * numCells + cell]; }
+	static bool IsFixed(uint64_t x) { return x != 0 && (x & (x - 1)) == 0; }
+	void SetAndPropagate(int ant, int cell, uint64_t value);
+	void Propagate(int ant, int cell);
+	template<class Policy> void Choose(int ant, int cell);
+	template<class Policy> void ChooseAcross();
+	void ChooseBatch(int first, int lanes);
+	template<class Policy> void ConstructGrid16(const Board& puzzle, const int *startCells);
+
+public:
+	// ants per batch of ANT_ENGINE_LANES
+	static const int numLanes = 8;
+
+	AntPopulation(IAntColony *parent) : parent(parent), numAnts(0), active(0), numUnits(0), numCells(0), mask(0), useGrid16(false), useLanes(false), cpCalls(0), pher(nullptr), pher0(0.0f) {}
+
+	// size the population for numAnts ants on puzzles of this order (grow only)
+	void Reset(int numAnts, int order, AntEngine engine = ANT_ENGINE_POPULATION);
+
+	// run only the first n ants (n <= numAnts of Reset; Reset runs all)
+	void SetActive(int n) { active = n; }
+
+	// one construction pass: ant a starts at startCells[a] and visits every
+	// cell; Policy supplies the local pheromone update (see pheromonepolicy.h)
+	template<class Policy> void Construct(const Board& puzzle, const int *startCells);
+
+	int NumCellsFilled(int ant) const { return numCells - failCells[ant]; }
+	// cell has no candidates left in ant's solution
+	bool CellEmpty(int ant, int cell) const
+	{
+		return useGrid16 ? grids[ant].Candidates(cell) == 0 : cand[(size_t)ant * numCells + cell] == 0;
+	}
+
+	// copy the solution of ant into out (out becomes a copy of puzzle first)
+	void ExportSolution(int ant, const Board& puzzle, Board& out);
+};
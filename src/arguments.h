@@ -3,6 +3,7 @@
 #include <string>
 #include <sstream>
 #include <cstring>
+#include <fstream>
 using namespace std;
 //
 // very simple command line argument handler
@@ -42,6 +43,34 @@ public:
 	{
 		ProcessArgs( argc, argv );
 	}
+	// read key=value defaults from the [section] of a config file
+	// arguments given on the command line take precedence
+	bool LoadConfig( const string &fileName, const string &section )
+	{
+		ifstream inFile(fileName);
+		if ( !inFile.is_open() )
+			return false;
+		string line;
+		bool inSection = false;
+		while ( getline(inFile, line) )
+		{
+			if ( line.empty() || line[0] == '#' )
+				continue;
+			if ( line[0] == '[' )
+			{
+				inSection = ( line.substr(1, line.find(']') - 1) == section );
+				continue;
+			}
+			size_t eq = line.find('=');
+			if ( inSection && eq != string::npos )
+			{
+				string argument = line.substr(0, eq);
+				if ( args.find(argument) == args.end() )
+					args[argument] = line.substr(eq + 1);
+			}
+		}
+		return true;
+	}
 	template<class T> T GetArg(const string &arg, const T& defaultValue ) 
 	{
 		T retVal = defaultValue;
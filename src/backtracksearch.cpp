@@ -2,23 +2,69 @@
 // backtracking search using the same comstraint propagation code as the ant colony system
 // HL 18/9/2017
 //
+// The search runs on an explicit stack of SearchFrames instead of recursion,
+// so it can be suspended after any number of nodes and resumed by Step().
+//
 #include "backtracksearch.h"
 #include "constraintpropagation.h"
 
-void BacktrackSearch::StepSolution(const Board &puzzle)
+BacktrackSearch::~BacktrackSearch()
+{
+	for (auto f : frames)
+		delete f;
+}
+
+// frame for a stack level, allocated the first time the level is reached
+BacktrackSearch::SearchFrame* BacktrackSearch::Frame(int level)
+{
+	while ((int)frames.size() <= level)
+		frames.push_back(new SearchFrame());
+	return frames[level];
+}
+
+// count the node, check the limits and pick its branching cell
+// returns false if the search has stopped (limit reached or solved)
+bool BacktrackSearch::EnterNode(SearchFrame *frame)
 {
-	// deal with timeout
-	if (timedOut)
-		return;
+	const Board &puzzle = frame->board;
 	stepCount++;
+	if ( maxSteps > 0 && stepCount > maxSteps )
+	{
+		timedOut = true;
+		return false;
+	}
 	if ( stepCount%5000 == 0 )
 	{
-		if ( solutionTimer.Elapsed() > timeOut )
+		if ( solutionTimer.Elapsed() > timeOut || (cancel != nullptr && cancel->load()) )
 		{
 			timedOut = true;
-			return;
+			return false;
 		}
 	}
+	if (useGrid16)
+	{
+		frame->cell = frame->grid.MostConstrainedCell();
+		frame->value = 0;
+		if (frame->cell == -1)
+		{
+			solved = true;
+			frame->grid.ToBoard(frames[0]->board, solution);
+			return false;
+		}
+		return true;
+	}
+	if (useBits)
+	{
+		frame->cell = frame->bits.MostConstrainedCell();
+		frame->value = 0;
+		if (frame->cell == -1)
+		{
+			solved = true;
+			frame->bits.ToBoard(frames[0]->board, solution);
+			return false;
+		}
+		return true;
+	}
 	// find the cell with the least number of possibilities (minimum remaining values heuristic)
 	int nextCell = -1;
 	int minCount = puzzle.GetNumUnits()+1;
@@ -37,48 +83,187 @@ void BacktrackSearch::StepSolution(const Board &puzzle)
 	{
 		solved = true;
 		solution.Copy(puzzle);
-		return;
+		return false;
+	}
+	frame->cell = nextCell;
+	frame->value = 0;
+	return true;
+}
+
+void BacktrackSearch::Start(const Board& puzzle, float maxTime)
+{
+	solved = false;
+	timedOut = false;
+	timeOut = maxTime;
+	stepCount = 0;
+	solutionTimer.Reset();
+	depth = 0;
+	SearchFrame *root = Frame(0);
+	root->board.Copy(puzzle);
+	root->cell = NODE_PENDING;
+	if (IsDeadEnd(puzzle.Hash()))
+	{
+		deadEndHits++;
+		depth = -1;
 	}
+	useGrid16 = grid16 && Grid16::Supports(puzzle.GetOrder());
+	useBits = !useGrid16 && valueMajor && BitBoard::Supports(puzzle.GetOrder());
+	if (useGrid16)
+	{
+		root->grid.FromBoard(puzzle);
+		if (!root->grid.Propagate())
+			depth = -1;
+	}
+	if (useBits)
+	{
+		root->bits.FromBoard(puzzle);
+		if (!root->bits.Propagate())
+			depth = -1;
+	}
+}
 
-	// try the possibilities in turn
-	ValueSet choice = ValueSet(puzzle.GetNumUnits(), 1);
-	for (int i = 0; i < puzzle.GetNumUnits(); i++)
+// value-major counterpart of the Board step below: returns false when all
+// values of the frame's cell have been tried
+bool BacktrackSearch::StepBits(SearchFrame *frame)
+{
+	uint64_t options = frame->bits.Candidates(frame->cell);
+	int numUnits = frame->bits.GetNumUnits();
+	while (frame->value < numUnits && !((options >> frame->value) & 1))
+		frame->value++;
+	if (frame->value == numUnits)
+		return false;
+	int value = frame->value++;
+
+	SearchFrame *child = Frame(depth + 1);
+	child->bits.Copy(frame->bits);
+	child->bits.Place(frame->cell, value);
+	if (child->bits.Propagate())
 	{
-		if (solved)
-			return;
-		if ( puzzle.GetCell(nextCell).Contains(choice))
+		if (child->bits.AllFixed())
 		{
-			// copy the board
-			Board newBoard;
-			newBoard.Copy(puzzle);
-			// set the cell
-		SetCellAndPropagate(newBoard, nextCell, choice);
-			// did we solve the puzzle?
-			if (newBoard.FixedCellCount() == newBoard.CellCount())
-			{
-				// solved
-				solved = true;
-				solution.Copy(newBoard);
-				return;
-			}
-			// check no conflicts
-			if (newBoard.InfeasibleCellCount() == 0)
+			solved = true;
+			child->bits.ToBoard(frames[0]->board, solution);
+		}
+		else
+		{
+			child->cell = NODE_PENDING;
+			depth++;
+		}
+	}
+	return true;
+}
+
+// the same on Grid16s
+bool BacktrackSearch::StepGrid16(SearchFrame *frame)
+{
+	uint16_t options = frame->grid.Candidates(frame->cell);
+	while (frame->value < 16 && !((options >> frame->value) & 1))
+		frame->value++;
+	if (frame->value == 16)
+		return false;
+	int value = frame->value++;
+
+	SearchFrame *child = Frame(depth + 1);
+	child->grid = frame->grid;
+	child->grid.Place(frame->cell, (uint16_t)(1 << value));
+	if (child->grid.Propagate())
+	{
+		if (child->grid.AllFixed())
+		{
+			solved = true;
+			child->grid.ToBoard(frames[0]->board, solution);
+		}
+		else
+		{
+			child->cell = NODE_PENDING;
+			depth++;
+		}
+	}
+	return true;
+}
+
+SolveProgress BacktrackSearch::Step(int budget)
+{
+	solutionTimer.Resume();
+	int startCount = stepCount;
+	while (!solved && !timedOut && depth >= 0 && stepCount - startCount < budget)
+	{
+		SearchFrame *frame = frames[depth];
+		if (frame->cell == NODE_PENDING)
+		{
+			EnterNode(frame);
+			continue;
+		}
+		if (useGrid16)
+		{
+			if (!StepGrid16(frame))
+				depth--;	// all values tried, backtrack
+			continue;
+		}
+		if (useBits)
+		{
+			if (!StepBits(frame))
+				depth--;	// all values tried, backtrack
+			continue;
+		}
+		// try the possibilities in turn
+		const ValueSet &options = frame->board.GetCell(frame->cell);
+		int numUnits = frame->board.GetNumUnits();
+		while (frame->value < numUnits && !options.Contains((uint64_t)1 << frame->value))
+			frame->value++;
+		if (frame->value == numUnits)
+		{
+			RecordDeadEnd(frame->board.Hash());
+			depth--;	// all values tried, backtrack
+			continue;
+		}
+		ValueSet choice = ValueSet(numUnits, (uint64_t)1 << frame->value);
+		frame->value++;
+
+		// copy the board and set the cell
+		SearchFrame *child = Frame(depth + 1);
+		child->board.Copy(frame->board);
+		SetCellAndPropagate(child->board, frame->cell, choice);
+		// did we solve the puzzle?
+		if (child->board.FixedCellCount() == child->board.CellCount())
+		{
+			solved = true;
+			solution.Copy(child->board);
+		}
+		// check no conflicts and no known dead end, then carry on and set the next cell
+		else if (child->board.InfeasibleCellCount() == 0)
+		{
+			if (IsDeadEnd(child->board.Hash()))
 			{
-				// carry on and set the next cell
-				StepSolution(newBoard);
+				deadEndHits++;
+				continue;
 			}
+			child->cell = NODE_PENDING;
+			depth++;
 		}
-		choice <<= 1;
 	}
+	solutionTimer.Pause();
+
+	SolveProgress progress;
+	progress.state = solved ? SOLVE_SOLVED : ((timedOut || depth < 0) ? SOLVE_FAILED : SOLVE_RUNNING);
+	progress.steps = stepCount - startCount;
+	progress.totalSteps = stepCount;
+	progress.bestScore = solved ? solution.CellCount() : (depth >= 0 ? FixedCount(frames[depth]) : 0);
+	progress.elapsed = solutionTimer.Elapsed();
+	return progress;
 }
 
-bool BacktrackSearch::Solve(const Board& puzzle, float maxTime)
+bool BacktrackSearch::Finish()
 {
-	solved = false;
-	timedOut = false;
-	timeOut = maxTime;
-	solutionTimer.Reset();
-	StepSolution(puzzle);
 	solTime = solutionTimer.Elapsed();
+	depth = -1;
 	return solved;
 }
+
+bool BacktrackSearch::Solve(const Board& puzzle, float maxTime)
+{
+	Start(puzzle, maxTime);
+	while (Step(5000).state == SOLVE_RUNNING)
+		;
+	return Finish();
+}
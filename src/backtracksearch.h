@@ -2,22 +2,89 @@
 #include "board.h"
 #include "timer.h"
 #include "sudokusolver.h"
+#include "bitboard.h"
+#include "grid16.h"
+#include <algorithm>
+#include <atomic>
+#include <vector>
 
 class BacktrackSearch : public SudokuSolver
 {
 private:
-	Timer solutionTimer;
+	// one level of the search: the board at this node, the branching cell
+	// and the next candidate value to try
+	struct SearchFrame
+	{
+		Board board;
+		BitBoard bits;	// the node's board when the search is value-major
+		Grid16 grid;	// the node's board on the 16x16 path
+		int cell;	// NODE_PENDING until the node has been entered
+		int value;
+	};
+	static const int NODE_PENDING = -2;
+
+	SliceTimer solutionTimer;
 	float solTime;
 	Board solution;
-	void StepSolution(const Board& board);
+	std::vector<SearchFrame*> frames;	// explicit search stack, grows to the deepest level
+	int depth;	// current top of the stack (-1 = exhausted)
+	bool EnterNode(SearchFrame *frame);
+	bool StepBits(SearchFrame *frame);
+	bool StepGrid16(SearchFrame *frame);
+	SearchFrame* Frame(int level);
 	bool solved;
 	int stepCount;
 	bool timedOut;
 	float timeOut;
+	int maxSteps;	// step limit (0 = unlimited), used for cheap probe searches
+	const std::atomic<bool> *cancel;	// optional external stop request
+	bool valueMajor;	// search on BitBoards (orders 3 to 5) instead of Boards
+	bool useBits;		// valueMajor and supported by the current puzzle
+	bool grid16;		// search 16x16 puzzles on Grid16s
+	bool useGrid16;		// grid16 and the current puzzle is 16x16
+	// transposition table of exhausted Board nodes, by Zobrist hash: a node's
+	// solutions only depend on its fixed cells, so a node with the hash of a
+	// node that had none is skipped. Direct mapped, kept across Start() calls
+	// on the same puzzle (see ExactFinisher)
+	std::vector<uint64_t> deadEnds;
+	int deadEndHits;
+	void RecordDeadEnd(uint64_t hash)
+	{
+		if (!deadEnds.empty())
+			deadEnds[hash & (deadEnds.size() - 1)] = hash;
+	}
+	bool IsDeadEnd(uint64_t hash) const
+	{
+		return !deadEnds.empty() && hash != 0 && deadEnds[hash & (deadEnds.size() - 1)] == hash;
+	}
+	int FixedCount(SearchFrame *frame)
+	{
+		if (useGrid16)
+			return frame->grid.FixedCellCount();
+		return useBits ? frame->bits.FixedCount() : frame->board.FixedCellCount();
+	}
 public:
-BacktrackSearch() : solTime(0.0f), stepCount(0), timedOut(false) {}
+BacktrackSearch() : solTime(0.0f), depth(-1), solved(false), stepCount(0), timedOut(false), timeOut(0.0f), maxSteps(0), cancel(nullptr), valueMajor(false), useBits(false), grid16(false), useGrid16(false), deadEndHits(0) {}
+	~BacktrackSearch();
 	virtual bool Solve(const Board& puzzle, float maxTime);
 	virtual float GetSolutionTime() { return solTime; }
 	virtual const Board& GetSolution() { return solution; }
+	// resumable interface; a work unit is one search node
+	virtual void Start(const Board& puzzle, float maxTime);
+	virtual SolveProgress Step(int budget);
+	virtual bool Finish();
 	int GetStepCount() { return stepCount; }
+	void SetStepLimit(int steps) { maxSteps = steps; }
+	void SetCancelFlag(const std::atomic<bool> *flag) { cancel = flag; }
+	// use the value-major BitBoard for nodes and propagation (orders 3 to 5)
+	void SetValueMajor(bool enable) { valueMajor = enable; }
+	// use Grid16 (uint16_t cells, AVX2 kernels) for 16x16 puzzles; takes
+	// precedence over SetValueMajor for that order
+	void SetGrid16(bool enable) { grid16 = enable; }
+	bool TimedOut() { return timedOut; }
+	// 2^log2Size entries (0 = no table); the table is only used on Board nodes
+	void SetTranspositionTable(int log2Size) { deadEnds.assign(log2Size > 0 ? (size_t)1 << log2Size : 0, 0); }
+	// forget all dead ends (the puzzle changes)
+	void ClearTranspositionTable() { std::fill(deadEnds.begin(), deadEnds.end(), 0); deadEndHits = 0; }
+	int GetTranspositionHits() { return deadEndHits; }
 };
@@ -0,0 +1,326 @@
+/*******************************************************************************
+ * BATCH SOLVER - Implementation
+ ******************************************************************************/
+
+#include "batchsolver.h"
+#include "backtracksearch.h"
+#include "board.h"
+#include <cstring>
+
+BatchKernel9::BatchKernel9(int maxDepth, int maxRounds) : maxDepth(maxDepth), maxRounds(maxRounds)
+{
+	levels.resize(maxDepth + 1);
+	active.assign(maxDepth + 1, 0);
+
+	// rows, columns, boxes
+	for (int u = 0; u < 9; u++)
+	{
+		for (int j = 0; j < 9; j++)
+		{
+			units[u][j] = u * 9 + j;
+			units[9 + u][j] = j * 9 + u;
+			units[18 + u][j] = (u / 3) * 27 + (u % 3) * 3 + (j / 3) * 9 + (j % 3);
+		}
+	}
+	for (int c = 0; c < 81; c++)
+	{
+		int n = 0;
+		int row = c / 9, col = c % 9, box = (row / 3) * 3 + col / 3;
+		for (int q = 0; q < 81; q++)
+		{
+			int qRow = q / 9, qCol = q % 9, qBox = (qRow / 3) * 3 + qCol / 3;
+			if (q != c && (qRow == row || qCol == col || qBox == box))
+				peers[c][n++] = q;
+		}
+	}
+}
+
+/*******************************************************************************
+ * Propagate - Naked and hidden singles on all lanes to a fixpoint
+ *
+ * Returns the lanes with a contradiction (a cell without candidates, or a
+ * digit with no place in a unit); solved receives the lanes whose cells are
+ * all fixed without contradiction.
+ ******************************************************************************/
+LaneMask BatchKernel9::Propagate(SlicedGrid& g, LaneMask& solved)
+{
+	LaneMask contra;
+	LaneMask allFixed;
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+		contra = 0;
+		allFixed = (LaneMask)~(LaneMask)0;
+
+		// naked singles: remove the value of fixed cells from their peers
+		for (int c = 0; c < 81; c++)
+		{
+			LaneMask ones = 0, twos = 0;
+			for (int d = 0; d < 9; d++)
+			{
+				twos |= ones & g.cand[c][d];
+				ones |= g.cand[c][d];
+			}
+			LaneMask single = ones & ~twos;
+			contra |= (LaneMask)~ones;
+			allFixed &= single;
+			LaneMask fresh = single & ~g.done[c];
+			if (fresh == 0)
+				continue;
+			g.done[c] |= fresh;
+			for (int d = 0; d < 9; d++)
+			{
+				LaneMask placed = g.cand[c][d] & fresh;
+				if (placed == 0)
+					continue;
+				for (int p = 0; p < 20; p++)
+				{
+					LaneMask &q = g.cand[peers[c][p]][d];
+					if (q & placed)
+					{
+						q &= ~placed;
+						changed = true;
+					}
+				}
+			}
+		}
+
+		// hidden singles: a digit seen once in a unit is fixed there
+		for (int u = 0; u < 27; u++)
+		{
+			for (int d = 0; d < 9; d++)
+			{
+				LaneMask ones = 0, twos = 0;
+				for (int j = 0; j < 9; j++)
+				{
+					LaneMask v = g.cand[units[u][j]][d];
+					twos |= ones & v;
+					ones |= v;
+				}
+				contra |= (LaneMask)~ones;
+				LaneMask once = ones & ~twos;
+				if (once == 0)
+					continue;
+				for (int j = 0; j < 9; j++)
+				{
+					int c = units[u][j];
+					LaneMask hidden = g.cand[c][d] & once;
+					if (hidden == 0)
+						continue;
+					for (int e = 0; e < 9; e++)
+					{
+						if (e != d && (g.cand[c][e] & hidden))
+						{
+							g.cand[c][e] &= ~hidden;
+							changed = true;
+						}
+					}
+				}
+			}
+		}
+	}
+	solved = allFixed & ~contra;
+	return contra;
+}
+
+void BatchKernel9::Load(int lane, const string& puzzle)
+{
+	LaneMask bit = (LaneMask)1 << lane;
+	SlicedGrid &g = levels[0];
+	for (int c = 0; c < 81; c++)
+	{
+		g.done[c] &= ~bit;
+		int given = (puzzle[c] >= '1' && puzzle[c] <= '9') ? puzzle[c] - '1' : -1;
+		for (int d = 0; d < 9; d++)
+		{
+			if (given < 0 || given == d)
+				g.cand[c][d] |= bit;
+			else
+				g.cand[c][d] &= ~bit;
+		}
+	}
+}
+
+/*******************************************************************************
+ * Branch - Move lanes from level to level+1 with a guess
+ *
+ * Each lane guesses the lowest candidate of its first cell with the fewest
+ * candidates; level+1 gets the guess, level keeps the alternative (the guess
+ * removed) for when the guess fails.
+ ******************************************************************************/
+void BatchKernel9::Branch(int level, LaneMask lanes)
+{
+	SlicedGrid &from = levels[level];
+	SlicedGrid &to = levels[level + 1];
+	LaneMask *src = &from.cand[0][0];
+	LaneMask *dst = &to.cand[0][0];
+	for (int i = 0; i < 81 * 9; i++)
+		dst[i] = (dst[i] & ~lanes) | (src[i] & lanes);
+	for (int c = 0; c < 81; c++)
+		to.done[c] = (to.done[c] & ~lanes) | (from.done[c] & lanes);
+
+	for (int lane = 0; lane < BATCH_LANES; lane++)
+	{
+		LaneMask bit = (LaneMask)1 << lane;
+		if (!(lanes & bit))
+			continue;
+		int bestCell = -1, bestCount = 10;
+		for (int c = 0; c < 81 && bestCount > 2; c++)
+		{
+			int count = 0;
+			for (int d = 0; d < 9; d++)
+				count += (from.cand[c][d] & bit) != 0;
+			if (count > 1 && count < bestCount)
+			{
+				bestCount = count;
+				bestCell = c;
+			}
+		}
+		int digit = 0;
+		while (!(from.cand[bestCell][digit] & bit))
+			digit++;
+		for (int e = 0; e < 9; e++)
+		{
+			if (e != digit)
+				to.cand[bestCell][e] &= ~bit;
+		}
+		from.cand[bestCell][digit] &= ~bit;
+	}
+}
+
+string BatchKernel9::Extract(const SlicedGrid& g, int lane) const
+{
+	LaneMask bit = (LaneMask)1 << lane;
+	string solution(81, '.');
+	for (int c = 0; c < 81; c++)
+		for (int d = 0; d < 9; d++)
+			if (g.cand[c][d] & bit)
+				solution[c] = '1' + d;
+	return solution;
+}
+
+void BatchKernel9::Run(const vector<string>& puzzles, vector<BatchResult>& results)
+{
+	results.assign(puzzles.size(), BatchResult());
+	for (auto& r : results)
+		r.status = BATCH_PEELED;
+
+	vector<int> lanePuzzle(BATCH_LANES, -1);
+	vector<int> laneRounds(BATCH_LANES, 0);
+	size_t next = 0;
+	LaneMask live = 0;
+	active.assign(maxDepth + 1, 0);
+
+	// load the next valid puzzles into the free lanes
+	auto refill = [&]()
+	{
+		for (int lane = 0; lane < BATCH_LANES && next < puzzles.size(); lane++)
+		{
+			LaneMask bit = (LaneMask)1 << lane;
+			if (live & bit)
+				continue;
+			while (next < puzzles.size() && puzzles[next].size() != 81)
+				results[next++].status = BATCH_INVALID;
+			if (next == puzzles.size())
+				break;
+			Load(lane, puzzles[next]);
+			lanePuzzle[lane] = (int)next++;
+			laneRounds[lane] = 0;
+			live |= bit;
+			active[0] |= bit;
+		}
+	};
+	auto finish = [&](LaneMask lanes, int level, BatchStatus status)
+	{
+		for (int lane = 0; lane < BATCH_LANES; lane++)
+		{
+			LaneMask bit = (LaneMask)1 << lane;
+			if (!(lanes & bit))
+				continue;
+			BatchResult &r = results[lanePuzzle[lane]];
+			r.status = status;
+			if (status == BATCH_SOLVED)
+				r.solution = Extract(levels[level], lane);
+		}
+		live &= ~lanes;
+	};
+
+	refill();
+	while (live)
+	{
+		for (int k = maxDepth; k >= 0; k--)
+		{
+			LaneMask lanes = active[k];
+			if (lanes == 0)
+				continue;
+			LaneMask solved;
+			LaneMask contra = Propagate(levels[k], solved) & lanes;
+			solved &= lanes;
+			finish(solved, k, BATCH_SOLVED);
+
+			// contradictions go back to the alternative one level up
+			if (k == 0)
+				finish(contra, k, BATCH_UNSOLVABLE);
+			else
+				active[k - 1] |= contra;
+
+			LaneMask open = lanes & ~solved & ~contra;
+			active[k] = 0;
+			if (open == 0)
+				continue;
+			if (k == maxDepth)
+				finish(open, k, BATCH_PEELED);
+			else
+			{
+				Branch(k, open);
+				active[k + 1] |= open;
+			}
+		}
+
+		// lanes over the round budget are peeled off
+		LaneMask overBudget = 0;
+		for (int lane = 0; lane < BATCH_LANES; lane++)
+		{
+			LaneMask bit = (LaneMask)1 << lane;
+			if ((live & bit) && ++laneRounds[lane] >= maxRounds)
+				overBudget |= bit;
+		}
+		if (overBudget)
+		{
+			finish(overBudget, 0, BATCH_PEELED);
+			for (int k = 0; k <= maxDepth; k++)
+				active[k] &= ~overBudget;
+		}
+		refill();
+	}
+	while (next < puzzles.size())
+		results[next++].status = BATCH_INVALID;
+}
+
+int SolveBatch(const vector<string>& puzzles, vector<BatchResult>& results, int maxDepth, int maxRounds, float timeOut)
+{
+	BatchKernel9 kernel(maxDepth, maxRounds);
+	kernel.Run(puzzles, results);
+
+	int peeled = 0;
+	BacktrackSearch search;
+	for (size_t i = 0; i < puzzles.size(); i++)
+	{
+		if (results[i].status != BATCH_PEELED)
+			continue;
+		peeled++;
+		Board board(puzzles[i]);
+		if (search.Solve(board, timeOut) && board.CheckSolution(search.GetSolution()))
+		{
+			const Board &solution = search.GetSolution();
+			results[i].solution.assign(81, '.');
+			for (int c = 0; c < 81; c++)
+				results[i].solution[c] = '1' + solution.GetCell(c).Index();
+			results[i].status = BATCH_SOLVED;
+		}
+		else if (!search.TimedOut())
+			results[i].status = BATCH_UNSOLVABLE;
+	}
+	return peeled;
+}
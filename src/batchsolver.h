@@ -0,0 +1,79 @@
+#pragma once
+/*******************************************************************************
+ * BATCH SOLVER - Bit-sliced propagation and search over many 9x9 puzzles
+ *
+ * For bulk jobs only the throughput matters. BatchKernel9 stores up to
+ * BATCH_LANES puzzles bit-sliced: cand[cell][digit] is a LaneMask whose bit k
+ * says whether digit is still possible in cell for the puzzle in lane k. Each
+ * propagation step is then a handful of AND/OR operations that act on all
+ * lanes at once (naked singles remove the value from the 20 peers, hidden
+ * singles are found per unit from "seen once" / "seen twice" masks).
+ *
+ * Search is a depth-first search run for all lanes together: level k of the
+ * stack holds one bit-sliced grid, and every lane sits on exactly one level.
+ * Branching copies the lane to level k+1 with a guess applied and removes the
+ * guess at level k, so a contradiction sends the lane back one level to the
+ * alternative. A lane that is solved, proven unsolvable, or that needs more
+ * than maxDepth levels or maxRounds rounds leaves the kernel, and the next
+ * puzzle of the input is loaded into its lane. Puzzles peeled off for deeper
+ * search are finished by the scalar BacktrackSearch (SolveBatch).
+ ******************************************************************************/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+using namespace std;
+
+// One bit per puzzle of a batch (uint8_t, uint16_t or uint64_t also work)
+typedef uint32_t LaneMask;
+static const int BATCH_LANES = 8 * sizeof(LaneMask);
+
+enum BatchStatus
+{
+	BATCH_SOLVED,		// solved by the kernel
+	BATCH_UNSOLVABLE,	// proven to have no solution
+	BATCH_PEELED,		// needs deeper search than the kernel allows
+	BATCH_INVALID		// not a 9x9 puzzle string
+};
+
+struct BatchResult
+{
+	BatchStatus status;
+	string solution;	// 81 digits, empty if not solved
+};
+
+class BatchKernel9
+{
+	struct SlicedGrid
+	{
+		LaneMask cand[81][9];
+		LaneMask done[81];	// lanes whose fixed value of the cell was removed from its peers
+	};
+
+	int maxDepth;
+	int maxRounds;
+	vector<SlicedGrid> levels;	// search stack, levels 0..maxDepth
+	vector<LaneMask> active;	// lanes on each level
+	int peers[81][20];
+	int units[27][9];
+
+	LaneMask Propagate(SlicedGrid& g, LaneMask& solved);
+	void Load(int lane, const string& puzzle);
+	void Branch(int level, LaneMask lanes);
+	string Extract(const SlicedGrid& g, int lane) const;
+
+public:
+	BatchKernel9(int maxDepth, int maxRounds);
+
+	// Solve all puzzles (81-character strings, '.' or '0' for blanks)
+	void Run(const vector<string>& puzzles, vector<BatchResult>& results);
+};
+
+/*******************************************************************************
+ * SolveBatch
+ *
+ * Runs the kernel on all puzzles, then finishes the peeled off ones with
+ * BacktrackSearch (timeOut seconds each). Returns the number of puzzles that
+ * needed the scalar search.
+ ******************************************************************************/
+int SolveBatch(const vector<string>& puzzles, vector<BatchResult>& results, int maxDepth, int maxRounds, float timeOut);
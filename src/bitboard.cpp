@@ -0,0 +1,303 @@
+/*******************************************************************************
+ * BITBOARD - Implementation
+ ******************************************************************************/
+
+#include "bitboard.h"
+#include <cstring>
+
+// number of bits set (Knuth, 'Sideways Addition', as in ValueSet)
+static inline int BitCount(uint64_t x)
+{
+	uint64_t y = x - ((x >> 1) & 0x5555555555555555ULL);
+	y = (y & 0x3333333333333333ULL) + ((y >> 2) & 0x3333333333333333ULL);
+	y = (y + (y >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+	return (int)((0x0101010101010101ULL * y) >> 56);
+}
+
+// index of the lowest set bit of x (x != 0)
+static inline int LowBitIndex(uint64_t x)
+{
+	double dx = (double)(x & (~x + 1));	// isolated bit, exact as a double
+	uint64_t bits;
+	memcpy(&bits, &dx, sizeof(bits));
+	return (int)((bits - 0x3FF0000000000000ULL) >> 52);
+}
+
+BitBoard::Geometry::Geometry(int order) : order(order)
+{
+	numUnits = order * order;
+	numCells = numUnits * numUnits;
+	numWords = (numCells + 63) / 64;
+	unitMasks.assign(3 * numUnits * numWords, 0);
+	peerMasks.assign(numCells * numWords, 0);
+	memset(allCells, 0, sizeof(allCells));
+	for (int c = 0; c < numCells; c++)
+		allCells[c >> 6] |= (uint64_t)1 << (c & 63);
+
+	// same cell numbering as Board::RowCell, ColCell and BoxCell
+	std::vector<int> unitOf(3 * numCells);
+	for (int u = 0; u < numUnits; u++)
+	{
+		int topCorner = (u % order) * order + (u / order) * order * order * order;
+		for (int j = 0; j < numUnits; j++)
+		{
+			int cells[3] = { u * numUnits + j, j * numUnits + u,
+			                 topCorner + (j % order) + (j / order) * order * order };
+			for (int t = 0; t < 3; t++)
+			{
+				int unit = t * numUnits + u;
+				unitMasks[unit * numWords + (cells[t] >> 6)] |= (uint64_t)1 << (cells[t] & 63);
+				unitOf[cells[t] * 3 + t] = unit;
+			}
+		}
+	}
+	for (int c = 0; c < numCells; c++)
+	{
+		uint64_t *peers = &peerMasks[c * numWords];
+		for (int t = 0; t < 3; t++)
+		{
+			const uint64_t *unit = &unitMasks[unitOf[c * 3 + t] * numWords];
+			for (int w = 0; w < numWords; w++)
+				peers[w] |= unit[w];
+		}
+		peers[c >> 6] &= ~((uint64_t)1 << (c & 63));
+	}
+}
+
+const BitBoard::Geometry& BitBoard::GetGeometry(int order)
+{
+	static const Geometry order3(3), order4(4), order5(5);
+	if (order == 3)
+		return order3;
+	if (order == 4)
+		return order4;
+	return order5;
+}
+
+void BitBoard::FromBoard(const Board& board)
+{
+	geometry = &GetGeometry(board.GetOrder());
+	int numWords = geometry->numWords;
+	for (int v = 0; v < geometry->numUnits; v++)
+		for (int w = 0; w < numWords; w++)
+			planes[v][w] = 0;
+	for (int w = 0; w < numWords; w++)
+		fixed[w] = 0;
+	for (int c = 0; c < geometry->numCells; c++)
+	{
+		uint64_t cand = board.GetCell(c).GetBits();
+		uint64_t bit = (uint64_t)1 << (c & 63);
+		for (int v = 0; v < geometry->numUnits; v++)
+		{
+			if ((cand >> v) & 1)
+				planes[v][c >> 6] |= bit;
+		}
+	}
+}
+
+void BitBoard::ToBoard(const Board& puzzle, Board& out) const
+{
+	out.Copy(puzzle);
+	int numUnits = geometry->numUnits;
+	for (int c = 0; c < geometry->numCells; c++)
+	{
+		ValueSet cell(numUnits, Candidates(c));
+		const ValueSet &old = puzzle.GetCell(c);
+		if (cell.GetBits() == old.GetBits())
+			continue;
+		out.SetCellDirect(c, cell);
+		if (cell.Fixed() && !old.Fixed())
+			out.IncrementFixedCells();
+		else if (cell.Empty())
+			out.IncrementInfeasible();
+	}
+}
+
+void BitBoard::Copy(const BitBoard& other)
+{
+	geometry = other.geometry;
+	int numWords = geometry->numWords;
+	for (int v = 0; v < geometry->numUnits; v++)
+		for (int w = 0; w < numWords; w++)
+			planes[v][w] = other.planes[v][w];
+	for (int w = 0; w < numWords; w++)
+		fixed[w] = other.fixed[w];
+}
+
+void BitBoard::Place(int cell, int value)
+{
+	int numWords = geometry->numWords;
+	int w = cell >> 6;
+	uint64_t bit = (uint64_t)1 << (cell & 63);
+	for (int v = 0; v < geometry->numUnits; v++)
+		planes[v][w] &= ~bit;
+	const uint64_t *peers = &geometry->peerMasks[cell * numWords];
+	for (int k = 0; k < numWords; k++)
+		planes[value][k] &= ~peers[k];
+	planes[value][w] |= bit;
+	fixed[w] |= bit;
+}
+
+uint64_t BitBoard::Candidates(int cell) const
+{
+	int w = cell >> 6, b = cell & 63;
+	uint64_t cand = 0;
+	for (int v = 0; v < geometry->numUnits; v++)
+		cand |= ((planes[v][w] >> b) & 1) << v;
+	return cand;
+}
+
+int BitBoard::ValueAt(int cell) const
+{
+	int w = cell >> 6;
+	uint64_t bit = (uint64_t)1 << (cell & 63);
+	for (int v = 0; v < geometry->numUnits; v++)
+		if (planes[v][w] & bit)
+			return v;
+	return -1;
+}
+
+int BitBoard::FixedCount() const
+{
+	int count = 0;
+	for (int w = 0; w < geometry->numWords; w++)
+		count += BitCount(fixed[w]);
+	return count;
+}
+
+int BitBoard::MostConstrainedCell() const
+{
+	int best = -1;
+	int bestCount = geometry->numUnits + 1;
+	for (int w = 0; w < geometry->numWords; w++)
+	{
+		uint64_t open = geometry->allCells[w] & ~fixed[w];
+		while (open)
+		{
+			int cell = w * 64 + LowBitIndex(open);
+			open &= open - 1;
+			int count = BitCount(Candidates(cell));
+			if (count < bestCount)
+			{
+				best = cell;
+				bestCount = count;
+				if (count <= 2)
+					return best;
+			}
+		}
+	}
+	return best;
+}
+
+bool BitBoard::Propagate()
+{
+	const Geometry &g = *geometry;
+	int numWords = g.numWords;
+	int numUnits = g.numUnits;
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+
+		// naked singles: cells with one candidate that are not placed yet
+		for (int w = 0; w < numWords; w++)
+		{
+			uint64_t ones = 0, twos = 0;
+			for (int v = 0; v < numUnits; v++)
+			{
+				twos |= ones & planes[v][w];
+				ones |= planes[v][w];
+			}
+			if ((ones & g.allCells[w]) != g.allCells[w])
+				return false;	// a cell without candidates
+			uint64_t fresh = ones & ~twos & ~fixed[w];
+			while (fresh)
+			{
+				int cell = w * 64 + LowBitIndex(fresh);
+				fresh &= fresh - 1;
+				// earlier placements may have changed this cell
+				uint64_t cand = Candidates(cell);
+				if (cand == 0)
+					return false;
+				if ((cand & (cand - 1)) == 0)
+				{
+					Place(cell, ValueAt(cell));
+					changed = true;
+				}
+			}
+		}
+
+		// hidden singles: a value with one place left in a unit
+		for (int u = 0; u < 3 * numUnits; u++)
+		{
+			const uint64_t *unit = &g.unitMasks[u * numWords];
+			for (int v = 0; v < numUnits; v++)
+			{
+				int count = 0;
+				int cell = -1;
+				bool placed = false;
+				for (int w = 0; w < numWords && count < 2; w++)
+				{
+					uint64_t x = planes[v][w] & unit[w];
+					if (x == 0)
+						continue;
+					if (x & fixed[w])
+					{
+						placed = true;
+						break;
+					}
+					count += (x & (x - 1)) ? 2 : 1;
+					cell = w * 64 + LowBitIndex(x);
+				}
+				if (placed)
+					continue;
+				if (count == 0)
+					return false;	// value has no place in the unit
+				if (count == 1)
+				{
+					Place(cell, v);
+					changed = true;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+static bool g_initialCPBitBoard = false;
+
+void SetInitialCPBitBoard(bool on)
+{
+	g_initialCPBitBoard = on;
+}
+
+bool InitialCPBitBoard(int order)
+{
+	return g_initialCPBitBoard && BitBoard::Supports(order);
+}
+
+bool PropagateInitialBits(Board& board, const std::vector<int>& givens)
+{
+	BitBoard bits;
+	bits.FromBoard(board);
+	int numCells = board.CellCount();
+	for (int i = 0; i < numCells; i++)
+	{
+		if (givens[i] > 0)
+			bits.Place(i, givens[i] - 1);
+	}
+	if (!bits.Propagate())
+		return false;
+
+	int numUnits = board.GetNumUnits();
+	for (int i = 0; i < numCells; i++)
+	{
+		ValueSet cell(numUnits, bits.Candidates(i));
+		if (cell.GetBits() == board.GetCell(i).GetBits())
+			continue;
+		board.SetCellDirect(i, cell);
+		if (cell.Fixed())
+			board.IncrementFixedCells();
+	}
+	return true;
+}
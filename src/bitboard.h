@@ -0,0 +1,88 @@
+#pragma once
+/*******************************************************************************
+ * BITBOARD - Value-major board representation for orders 3 to 5
+ *
+ * Board is cell-major: one ValueSet per cell. BitBoard keeps one bitboard per
+ * value instead, a plane of numCells bits (up to 625, ten 64-bit words) that
+ * has the bit of a cell set while the value is still possible there. With
+ * precomputed unit and peer masks per order:
+ * - placing a value clears the cell in the other planes and ANDs the value's
+ *   plane with the complement of the cell's peer mask
+ * - a hidden single is a value whose plane meets a unit mask in one bit
+ * - naked singles and empty cells come from "seen once" / "seen twice" masks
+ *   accumulated over the planes, 64 cells at a time
+ *
+ * Propagate() applies naked and hidden singles to a fixpoint, which is the
+ * constraint propagation of constraintpropagation.cpp run to completion.
+ * BacktrackSearch uses BitBoard when SetValueMajor(true) is set, and the
+ * initial propagation of the givens in the Board constructor can run on a
+ * BitBoard for orders 3 to 5 (PropagateInitialBits, with --cpfixpoint 1
+ * and --cpbitboard 1).
+ ******************************************************************************/
+
+#include "board.h"
+#include <cstdint>
+#include <vector>
+
+static const int BITBOARD_MAX_UNITS = 25;
+static const int BITBOARD_MAX_WORDS = 10;	// 625 cells
+
+class BitBoard
+{
+	// unit and peer masks of one order, built once
+	struct Geometry
+	{
+		int order;
+		int numUnits;
+		int numCells;
+		int numWords;
+		std::vector<uint64_t> unitMasks;	// 3*numUnits masks (rows, columns, boxes)
+		std::vector<uint64_t> peerMasks;	// numCells masks, without the cell itself
+		uint64_t allCells[BITBOARD_MAX_WORDS];
+		Geometry(int order);
+	};
+	static const Geometry& GetGeometry(int order);
+
+	const Geometry *geometry;
+	uint64_t planes[BITBOARD_MAX_UNITS][BITBOARD_MAX_WORDS];
+	uint64_t fixed[BITBOARD_MAX_WORDS];	// cells whose value has been placed
+
+	int ValueAt(int cell) const;
+
+public:
+	BitBoard() : geometry(nullptr) {}
+
+	static bool Supports(int order) { return order >= 3 && order <= 5; }
+
+	// candidates of every cell of board; placed values are propagated by Propagate()
+	void FromBoard(const Board& board);
+	// out becomes puzzle with the candidates of this bitboard
+	void ToBoard(const Board& puzzle, Board& out) const;
+	void Copy(const BitBoard& other);
+
+	// set cell to value and remove value from its peers
+	void Place(int cell, int value);
+	// naked and hidden singles to a fixpoint; false on a contradiction
+	bool Propagate();
+
+	uint64_t Candidates(int cell) const;
+	bool IsFixed(int cell) const { return (fixed[cell >> 6] >> (cell & 63)) & 1; }
+	int FixedCount() const;
+	bool AllFixed() const { return FixedCount() == geometry->numCells; }
+	// unfixed cell with the fewest candidates, -1 if all cells are fixed
+	int MostConstrainedCell() const;
+	int GetNumUnits() const { return geometry->numUnits; }
+	int CellCount() const { return geometry->numCells; }
+};
+
+// use PropagateInitialBits for the initial propagation of orders 3 to 5 when
+// it runs to the fixpoint (SetInitialCPFixpoint; default off = serial path)
+void SetInitialCPBitBoard(bool on);
+bool InitialCPBitBoard(int order);
+
+// Propagate the givens (value index + 1 of each cell, 0 = open) of a board of
+// order 3 to 5 whose cells are all open, on a BitBoard, to the fixpoint of
+// naked and hidden singles, and write the candidates back into board. This is
+// the fixpoint the serial path reaches with PropagateToFixpoint. Returns false on
+// a contradiction, leaving board unchanged.
+bool PropagateInitialBits(Board& board, const std::vector<int>& givens);
@@ -0,0 +1,112 @@
+/*******************************************************************************
+ * BLANK GRID - Implementation
+ ******************************************************************************/
+
+#include "blankgrid.h"
+#include "constraintpropagation.h"
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+static int OrderOf(const Board& board)
+{
+	int order = 0;
+	while (order*order < board.GetNumUnits())
+		order++;
+	return order;
+}
+
+static ValueSet ValueFor(int numUnits, int v)
+{
+	return ValueSet(numUnits, (uint64_t)1 << v);
+}
+
+BlankGridMode ParseBlankGridMode(const string& mode)
+{
+	if (mode == "row")
+		return BLANK_ROW;
+	if (mode == "box")
+		return BLANK_BOX;
+	if (mode == "pattern")
+		return BLANK_PATTERN;
+	return BLANK_SEARCH;
+}
+
+string MakeBlankGrid(int order)
+{
+	return string(order*order*order*order, '.');
+}
+
+void SeedBlankGrid(Board& board, BlankGridMode mode)
+{
+	int numUnits = board.GetNumUnits();
+	switch (mode)
+	{
+	case BLANK_ROW:
+		for (int j = 0; j < numUnits; j++)
+			SetCellAndPropagate(board, board.RowCell(0, j), ValueFor(numUnits, j));
+		break;
+	case BLANK_BOX:
+		for (int j = 0; j < numUnits; j++)
+			SetCellAndPropagate(board, board.BoxCell(0, j), ValueFor(numUnits, j));
+		break;
+	case BLANK_PATTERN:
+		PatternGrid(board);
+		break;
+	case BLANK_SEARCH:
+	default:
+		break;
+	}
+}
+
+// random permutation of 0..n-1 that keeps groups of size 'order' together
+static vector<int> BandPermutation(int order, std::mt19937& randGen)
+{
+	vector<int> bands(order), inner(order), perm;
+	iota(bands.begin(), bands.end(), 0);
+	shuffle(bands.begin(), bands.end(), randGen);
+	for (int b = 0; b < order; b++)
+	{
+		iota(inner.begin(), inner.end(), 0);
+		shuffle(inner.begin(), inner.end(), randGen);
+		for (int i = 0; i < order; i++)
+			perm.push_back(bands[b]*order + inner[i]);
+	}
+	return perm;
+}
+
+void PatternGrid(Board& board, std::mt19937* randGen)
+{
+	int order = OrderOf(board);
+	int numUnits = board.GetNumUnits();
+
+	vector<int> rowMap(numUnits), colMap(numUnits), digitMap(numUnits);
+	iota(rowMap.begin(), rowMap.end(), 0);
+	iota(colMap.begin(), colMap.end(), 0);
+	iota(digitMap.begin(), digitMap.end(), 0);
+	bool transpose = false;
+	if (randGen != nullptr)
+	{
+		rowMap = BandPermutation(order, *randGen);
+		colMap = BandPermutation(order, *randGen);
+		shuffle(digitMap.begin(), digitMap.end(), *randGen);
+		transpose = ((*randGen)() & 1) != 0;
+	}
+
+	// the cells are written directly: the layout is valid by construction,
+	// so there is nothing for constraint propagation to do
+	for (int iRow = 0; iRow < numUnits; iRow++)
+	{
+		for (int iCol = 0; iCol < numUnits; iCol++)
+		{
+			int r = rowMap[transpose ? iCol : iRow];
+			int c = colMap[transpose ? iRow : iCol];
+			int v = digitMap[(order*(r%order) + r/order + c) % numUnits];
+			int iCell = board.RowCell(iRow, iCol);
+			if (board.GetCell(iCell).Fixed())
+				continue;
+			board.SetCellDirect(iCell, ValueFor(numUnits, v));
+			board.IncrementFixedCells();
+		}
+	}
+}
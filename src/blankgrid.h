@@ -0,0 +1,61 @@
+#pragma once
+/*******************************************************************************
+ * BLANK GRID - Symmetry-broken construction of full grids
+ *
+ * A blank grid can be relabelled (digit permutations), and rows and columns
+ * can be permuted within bands/stacks without changing whether it can be
+ * completed. Searching a blank grid from scratch therefore spends most of its
+ * time on choices that do not matter. The modes below fix a canonical part of
+ * the grid first:
+ *
+ * - BLANK_ROW:     seed the first row with 1..N, search the rest
+ * - BLANK_BOX:     seed the first box with 1..N, search the rest
+ * - BLANK_PATTERN: write a complete pattern-based Latin layout directly,
+ *                  no search at all (milliseconds up to order 8)
+ *
+ * PatternGrid can also apply random symmetry transformations, which makes it a
+ * fast source of varied full grids for instance generation.
+ ******************************************************************************/
+
+#include "board.h"
+#include <random>
+#include <string>
+using namespace std;
+
+enum BlankGridMode
+{
+	BLANK_SEARCH,	// no seeding, the solver fills the whole grid
+	BLANK_ROW,
+	BLANK_BOX,
+	BLANK_PATTERN
+};
+
+// Parse a --blankmode value (search, row, box or pattern)
+BlankGridMode ParseBlankGridMode(const string& mode);
+
+/*******************************************************************************
+ * MakeBlankGrid
+ *
+ * Returns the puzzle string for a blank grid of the given order. For the
+ * seeded modes the caller should then call SeedBlankGrid on the board.
+ ******************************************************************************/
+string MakeBlankGrid(int order);
+
+/*******************************************************************************
+ * SeedBlankGrid
+ *
+ * Applies the canonical seed for mode to a blank board, with constraint
+ * propagation. For BLANK_PATTERN the board is completely filled.
+ ******************************************************************************/
+void SeedBlankGrid(Board& board, BlankGridMode mode);
+
+/*******************************************************************************
+ * PatternGrid
+ *
+ * Fills a blank board with the Latin layout
+ *     value(r, c) = (order*(r % order) + r / order + c) mod N
+ * which is a valid grid for every order. If randGen is given, random digit
+ * relabelling, row/column permutations within bands/stacks, band/stack
+ * permutations and transposition are applied.
+ ******************************************************************************/
+void PatternGrid(Board& board, std::mt19937* randGen = nullptr);
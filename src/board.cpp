@@ -13,6 +13,9 @@
 
 #include "board.h"
 #include "constraintpropagation.h"
+#include "parallelpropagation.h"
+#include "bitboard.h"
+#include "timer.h"
 #include <iostream>
 #include <iomanip>
 #include <inttypes.h>
@@ -68,25 +71,12 @@ Board::Board(const string &puzzleString)
 	numCells = numUnits * numUnits;
 	
 	cells = new ValueSet[numCells];
+	capacity = numCells;
 
 	int maxVal = numUnits;
 
-	// Initialize all cells with all possible values
-	for (int i = 0; i < numCells; i++)
-		cells[i].Init(maxVal);
-
-	for ( int i = 0; i < numCells; i++ )
-	{
-		cells[i] = ~cells[i];
-	}
-	
-	// Set the known cells one by one using constraint propagation
-	numInfeasible = 0;
-	numFixedCells = 0;
-	
-	// Mark that we're in initial CP phase (for timing)
-	BeginInitialCP();
-	
+	// Value (index + 1) of every given, 0 for an open cell
+	std::vector<int> givens(numCells, 0);
 	for (int i = 0; i < numCells; i++)
 	{
 		if (puzzleString[i] != '.')
@@ -105,16 +95,75 @@ Board::Board(const string &puzzleString)
 				break;
 			case 5:
 			default:
-				value = 1+(int)(puzzleString[i] - 'a');
+				// from order 6 the values run past 'z' (unsigned bytes)
+				value = 1+(int)((unsigned char)puzzleString[i] - 'a');
 			}
-			SetCellAndPropagate(*this, i, ValueSet(maxVal, (int64_t)1 << (value-1) ));
+			givens[i] = value;
 		}
 	}
+
+	// With --cpfixpoint the givens are propagated to the fixpoint of both
+	// rules, which large boards reach in parallel (see parallelpropagation.h),
+	// falling back to the serial path below on a contradiction
+	bool fixpoint = InitialCPFixpoint();
+	int cpThreads = InitialCPThreads(order);
+	if (fixpoint && cpThreads > 1)
+	{
+		ResetCells();
+		Timer cpTimer;
+		cpTimer.Reset();
+		bool propagated = PropagateInitialParallel(*this, givens, cpThreads);
+		AddInitialCPTime(cpTimer.Elapsed());
+		if (propagated)
+			return;
+	}
+
+	// Orders 3 to 5: the same fixpoint on a value-major BitBoard (see
+	// bitboard.h), again with the serial path below as the fallback
+	if (fixpoint && InitialCPBitBoard(order))
+	{
+		ResetCells();
+		Timer cpTimer;
+		cpTimer.Reset();
+		bool propagated = PropagateInitialBits(*this, givens);
+		AddInitialCPTime(cpTimer.Elapsed());
+		if (propagated)
+			return;
+	}
+
+	// Set the known cells one by one using constraint propagation
+	ResetCells();
+	
+	// Mark that we're in initial CP phase (for timing)
+	BeginInitialCP();
+	
+	for (int i = 0; i < numCells; i++)
+	{
+		if (givens[i] > 0)
+			SetCellAndPropagate(*this, i, ValueSet(maxVal, (int64_t)1 << (givens[i]-1) ));
+	}
+	if (fixpoint)
+		PropagateToFixpoint(*this);
 	
 	// End initial CP phase
 	EndInitialCP();
 }
 
+/*******************************************************************************
+ * ResetCells - Open every cell (all values possible) and clear the counters
+ ******************************************************************************/
+void Board::ResetCells()
+{
+	for (int i = 0; i < numCells; i++)
+	{
+		cells[i].Init(numUnits);
+		cells[i] = ~cells[i];
+	}
+	numInfeasible = 0;
+	numFixedCells = 0;
+	hash = 0;
+}
+
 /*******************************************************************************
  * Copy Constructor - Create a new board as a copy of another
  ******************************************************************************/
@@ -125,6 +174,9 @@ Board::Board(const Board &other)
 
 /*******************************************************************************
  * Copy - Deep copy another board's state
+ * 
+ * The cell buffer only grows: copying a board of the same or a smaller order
+ * does not allocate, so working boards can be reused across puzzles.
  ******************************************************************************/
 void Board::Copy(const Board& other)
 {
@@ -132,16 +184,20 @@ void Board::Copy(const Board& other)
 	numUnits = order * order;
 	numCells = numUnits * numUnits;
 
-	if (cells == nullptr)
+	if (numCells > capacity)
+	{
+		if (cells != nullptr)
+			delete [] cells;
 		cells = new ValueSet[numCells];
-
-	int maxVal = numUnits;
+		capacity = numCells;
+	}
 
 	for (int i = 0; i < numCells; i++)
 		cells[i] = other.GetCell(i);
 
 	numFixedCells = other.FixedCellCount();
 	numInfeasible = other.InfeasibleCellCount();
+	hash = other.hash;
 }
 
 /*******************************************************************************
@@ -382,12 +438,33 @@ bool Board::CheckSolution(const Board& other) const
 // These methods are used by constraintpropagation.cpp
 // ============================================================================
 
+/*******************************************************************************
+ * ZobristKey - Random key of value v in cell i
+ * The keys are not stored: each is the SplitMix64 output for (i, v), so all
+ * boards of any order share them without a table.
+ ******************************************************************************/
+static inline uint64_t ZobristKey(int i, int v)
+{
+	uint64_t z = (((uint64_t)i << 6) | (uint64_t)v) * 0x9E3779B97F4A7C15ULL + 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
 /*******************************************************************************
  * SetCellDirect - Set a cell value without propagation
  * Used internally by constraint propagation module
+ * The observer (if any) sees the old and new value before the change.
+ * The hash gains the key of a newly fixed value and loses the old one.
  ******************************************************************************/
 void Board::SetCellDirect(int i, const ValueSet &c)
 {
+	if (observer != nullptr)
+		observer->CellChanged(i, cells[i], c);
+	if (cells[i].Fixed())
+		hash ^= ZobristKey(i, cells[i].Index());
+	if (c.Fixed())
+		hash ^= ZobristKey(i, c.Index());
 	cells[i] = c;
 }
 
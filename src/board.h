@@ -10,6 +10,14 @@ bool Rule2_HiddenSingle(class Board& board, int cellIndex);
 void PropagateConstraints(class Board& board, int cellIndex);
 void SetCellAndPropagate(class Board& board, int cellIndex, const ValueSet& value);
 
+// Receives every change of a cell's value set (see Board::SetObserver)
+class BoardObserver
+{
+public:
+	virtual ~BoardObserver() {}
+	virtual void CellChanged(int i, const ValueSet &oldValue, const ValueSet &newValue) = 0;
+};
+
 class Board
 {
 public:
@@ -23,8 +31,13 @@ public:
 	int FixedCellCount(void) const;
 	int InfeasibleCellCount(void) const;
 	const ValueSet &GetCell(int i) const;
+	// Zobrist hash of the fixed cells (XOR of one random key per cell and
+	// value), kept up to date by SetCellDirect; equal boards have equal hashes
+	uint64_t Hash() const { return hash; }
 
 	int GetNumUnits() const;
+	int GetOrder() const { return order; }
+	// copy other into this board; the cell buffer is reused unless it is too small
 	void Copy(const Board &other);
 	int CellCount(void) const;
 	bool CheckSolution(const Board& other) const;
@@ -36,18 +49,29 @@ public:
 	int ColForCell(int iCell) const;
 	int BoxForCell(int iCell) const;
 
+	// Optional observer notified of every cell change; not copied by Copy()
+	void SetObserver(BoardObserver *obs) { observer = obs; }
+
 	// Internal methods for constraint propagation (used by constraintpropagation.cpp)
 	void SetCellDirect(int i, const ValueSet &c);
 	void IncrementFixedCells();
 	void IncrementInfeasible();
+	// set both counters back to earlier values (used by BoardTrail::Undo)
+	void RestoreCounters(int fixedCells, int infeasibleCells) { numFixedCells = fixedCells; numInfeasible = infeasibleCells; }
 
 private:
+	// open every cell and clear the counters and hash (construction)
+	void ResetCells();
+
 	ValueSet *cells = nullptr;
+	int capacity = 0;	// number of cells allocated
+	BoardObserver *observer = nullptr;
 
-	int order;   // order of puzzle
-	int numUnits; // number of units (rows, columns, blocks)
-	int numCells; // number of cells
-	int numFixedCells; // number of cells with uniquely determined value
-	int numInfeasible; // number of cells with no possibilities.
+	int order = 0;   // order of puzzle
+	int numUnits = 0; // number of units (rows, columns, blocks)
+	int numCells = 0; // number of cells
+	int numFixedCells = 0; // number of cells with uniquely determined value
+	int numInfeasible = 0; // number of cells with no possibilities.
+	uint64_t hash = 0; // Zobrist hash of the fixed cells
 };
 
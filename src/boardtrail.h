@@ -0,0 +1,73 @@
+#pragma once
+#include "board.h"
+#include <vector>
+
+//
+// Undo log of a board, kept as a BoardObserver: every cell change is recorded
+// with the cell's old value set, so the board can be rolled back to any
+// earlier mark by restoring the old values in reverse order. Propagation only
+// ever removes candidates, so between two rollbacks a cell changes at most
+// numUnits times and the log never holds more than numCells * numUnits
+// entries; Reserve() sizes it for that once.
+//
+class BoardTrail : public BoardObserver
+{
+	struct Entry
+	{
+		int cell;
+		ValueSet oldValue;
+	};
+	std::vector<Entry> entries;
+	int size;	// entries in use
+
+public:
+	// A position in the trail together with the board counters at that point
+	struct Mark
+	{
+		int size;
+		int fixedCells;
+		int infeasibleCells;
+	};
+
+	BoardTrail() : size(0) {}
+
+	// room for a full construction on boards of up to numUnits values
+	void Reserve(int numUnits)
+	{
+		size_t n = (size_t)numUnits * numUnits * numUnits;
+		if (entries.size() < n)
+			entries.resize(n);
+	}
+	void Clear() { size = 0; }
+
+	Mark GetMark(const Board& board) const
+	{
+		Mark m;
+		m.size = size;
+		m.fixedCells = board.FixedCellCount();
+		m.infeasibleCells = board.InfeasibleCellCount();
+		return m;
+	}
+
+	// Restore board to its state at mark m (the board must be observed by this trail)
+	void Undo(Board& board, const Mark& m)
+	{
+		board.SetObserver(nullptr);
+		while (size > m.size)
+		{
+			--size;
+			board.SetCellDirect(entries[size].cell, entries[size].oldValue);
+		}
+		board.RestoreCounters(m.fixedCells, m.infeasibleCells);
+		board.SetObserver(this);
+	}
+
+	virtual void CellChanged(int i, const ValueSet &oldValue, const ValueSet &)
+	{
+		if (size == (int)entries.size())
+			entries.resize(entries.size() * 2 + 1);
+		entries[size].cell = i;
+		entries[size].oldValue = oldValue;
+		++size;
+	}
+};
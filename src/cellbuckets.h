@@ -0,0 +1,110 @@
+#pragma once
+#include "board.h"
+#include <vector>
+
+//
+// Unvisited cells of a board bucketed by their number of remaining candidates,
+// kept up to date incrementally as a BoardObserver.
+// All cells live in one array partitioned into buckets 0..numUnits by
+// candidate count, followed by a bucket for visited cells. Moving a cell to a
+// neighbouring bucket is a swap with the bucket boundary, so a change of k
+// candidates costs O(k), and a random cell of the lowest non-empty bucket can
+// be drawn in O(numUnits).
+//
+class CellBuckets : public BoardObserver
+{
+	int numUnits;
+	int visitedBucket;			// index of the bucket holding visited cells
+	std::vector<int> cellAt;	// cells, ordered by bucket
+	std::vector<int> posOf;		// position of each cell in cellAt
+	std::vector<int> bucketOf;	// current bucket of each cell
+	std::vector<int> start;		// first position of each bucket (+ end sentinel)
+
+	void Swap(int p, int q)
+	{
+		int a = cellAt[p], b = cellAt[q];
+		cellAt[p] = b; posOf[b] = p;
+		cellAt[q] = a; posOf[a] = q;
+	}
+	// move cell one bucket up (to the right)
+	void MoveUp(int cell)
+	{
+		int b = bucketOf[cell];
+		Swap(posOf[cell], start[b + 1] - 1);
+		start[b + 1]--;
+		bucketOf[cell] = b + 1;
+	}
+	// move cell one bucket down (to the left)
+	void MoveDown(int cell)
+	{
+		int b = bucketOf[cell];
+		Swap(posOf[cell], start[b]);
+		start[b]++;
+		bucketOf[cell] = b - 1;
+	}
+	void MoveTo(int cell, int bucket)
+	{
+		while (bucketOf[cell] < bucket)
+			MoveUp(cell);
+		while (bucketOf[cell] > bucket)
+			MoveDown(cell);
+	}
+
+public:
+	CellBuckets() : numUnits(0), visitedBucket(0) {}
+
+	// Bucket all cells of board by candidate count (no allocation once sized)
+	void Init(const Board& board)
+	{
+		numUnits = board.GetNumUnits();
+		visitedBucket = numUnits + 1;
+		int numCells = board.CellCount();
+		cellAt.resize(numCells);
+		posOf.resize(numCells);
+		bucketOf.resize(numCells);
+		start.assign(visitedBucket + 2, 0);
+
+		// counting sort by candidate count
+		for (int i = 0; i < numCells; i++)
+			start[board.GetCell(i).Count() + 1]++;
+		for (int b = 1; b <= visitedBucket + 1; b++)
+			start[b] += start[b - 1];
+		for (int i = 0; i < numCells; i++)
+		{
+			int b = board.GetCell(i).Count();
+			int p = start[b]++;
+			cellAt[p] = i;
+			posOf[i] = p;
+			bucketOf[i] = b;
+		}
+		// restore the bucket starts shifted by the placement loop
+		for (int b = visitedBucket + 1; b > 0; b--)
+			start[b] = start[b - 1];
+		start[0] = 0;
+	}
+
+	virtual void CellChanged(int i, const ValueSet &, const ValueSet &newValue)
+	{
+		if (bucketOf[i] != visitedBucket)
+			MoveTo(i, newValue.Count());
+	}
+
+	// Mark a cell as visited: it is no longer returned by Next()
+	void Visit(int cell)
+	{
+		MoveTo(cell, visitedBucket);
+	}
+
+	// Lowest non-empty bucket of unvisited cells, or -1 if all are visited
+	int LowestBucket() const
+	{
+		for (int b = 0; b < visitedBucket; b++)
+			if (start[b + 1] > start[b])
+				return b;
+		return -1;
+	}
+
+	int BucketSize(int b) const { return start[b + 1] - start[b]; }
+	// k'th cell (0 <= k < BucketSize(b)) of bucket b
+	int CellInBucket(int b, int k) const { return cellAt[start[b] + k]; }
+};
@@ -50,6 +50,11 @@ int GetCPCallCount()
 	return g_cpCallCount.load();
 }
 
+void AddAntCPCalls(int calls)
+{
+	g_cpCallCount.fetch_add(calls);
+}
+
 // Mark that we're in initial CP phase (called from Board constructor)
 void BeginInitialCP()
 {
@@ -61,6 +66,11 @@ void EndInitialCP()
 	g_inInitialCP = false;
 }
 
+void AddInitialCPTime(float secs)
+{
+	AtomicAddFloat(g_initialCPTime, secs);
+}
+
 /*******************************************************************************
  * Rule1_Elimination
  * 
@@ -309,3 +319,37 @@ void SetCellAndPropagate(Board& board, int cellIndex, const ValueSet& value)
 			PropagateConstraints(board, k);
 	}
 }
+
+/*******************************************************************************
+ * PropagateToFixpoint
+ * 
+ * Sweeps over all cells, applying both rules to the open ones, until a sweep
+ * leaves every cell unchanged.
+ ******************************************************************************/
+void PropagateToFixpoint(Board& board)
+{
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+		for (int i = 0; i < board.CellCount(); i++)
+		{
+			uint64_t before = board.GetCell(i).GetBits();
+			PropagateConstraints(board, i);
+			if (board.GetCell(i).GetBits() != before)
+				changed = true;
+		}
+	}
+}
+
+static bool g_initialCPFixpoint = false;
+
+void SetInitialCPFixpoint(bool on)
+{
+	g_initialCPFixpoint = on;
+}
+
+bool InitialCPFixpoint()
+{
+	return g_initialCPFixpoint;
+}
@@ -44,9 +44,14 @@ float GetInitialCPTime();
 float GetAntCPTime();
 int GetCPCallCount();
 
+// Count CP calls made outside this module (AntPopulation's own propagation)
+void AddAntCPCalls(int calls);
+
 // Internal: Mark initial CP phase (called from Board constructor)
 void BeginInitialCP();
 void EndInitialCP();
+// Charge time spent outside the rules to the initial CP (parallel propagation)
+void AddInitialCPTime(float secs);
 
 /*******************************************************************************
  * Rule1_Elimination
@@ -112,3 +117,22 @@ void PropagateConstraints(Board& board, int cellIndex);
  *   value      - The ValueSet containing the value to set (should be a single value)
  ******************************************************************************/
 void SetCellAndPropagate(Board& board, int cellIndex, const ValueSet& value);
+
+/*******************************************************************************
+ * PropagateToFixpoint
+ * 
+ * SetCellAndPropagate only revisits the peers of a newly fixed cell, so a
+ * hidden single created by an elimination elsewhere can be missed. This
+ * applies both rules to every open cell until a sweep changes nothing, which
+ * makes the result independent of the order the givens were set in.
+ * 
+ * Parameters:
+ *   board      - The Sudoku board to operate on
+ ******************************************************************************/
+void PropagateToFixpoint(Board& board);
+
+// propagate the givens of a new Board to the fixpoint (default off = the
+// cascade of SetCellAndPropagate alone); only then does the Board constructor
+// use the parallel and BitBoard paths, which reach the same fixpoint
+void SetInitialCPFixpoint(bool on);
+bool InitialCPFixpoint();
@@ -0,0 +1,140 @@
+/*******************************************************************************
+ * DIFFICULTY ESTIMATOR - Implementation
+ *
+ * The routing thresholds below were chosen by hand from the general instance
+ * set; the CSV log written by LogRoute is meant for re-fitting them.
+ ******************************************************************************/
+
+#include "difficultyestimator.h"
+#include "backtracksearch.h"
+#include "timer.h"
+#include <fstream>
+#include <iostream>
+
+// fixed cell ratio at or above which an instance counts as well-constrained
+static const float WELL_CONSTRAINED_RATIO = 0.6f;
+// mean candidates per open cell at or below which backtracking is preferred
+static const float LOW_BRANCHING = 2.5f;
+// time limit for the probe (the step limit is normally reached first)
+static const float PROBE_MAX_TIME = 1.0f;
+
+DifficultyFeatures EstimateDifficulty(const Board& board, int probeStepLimit, Board& probeSolution)
+{
+	DifficultyFeatures f;
+	int numUnits = board.GetNumUnits();
+	f.numCells = board.CellCount();
+	f.order = 0;
+	while (f.order*f.order < numUnits)
+		f.order++;
+	f.fixedCells = board.FixedCellCount();
+	f.fixedRatio = f.fixedCells / (float)f.numCells;
+
+	// candidate histogram over the open cells
+	f.candidateHistogram.assign(numUnits + 1, 0);
+	int openCells = 0;
+	int totalCandidates = 0;
+	for (int i = 0; i < f.numCells; i++)
+	{
+		const ValueSet& cell = board.GetCell(i);
+		if (cell.Fixed())
+			continue;
+		f.candidateHistogram[cell.Count()]++;
+		totalCandidates += cell.Count();
+		openCells++;
+	}
+	f.meanCandidates = (openCells > 0) ? totalCandidates / (float)openCells : 0.0f;
+
+	// short probe search
+	f.probeSteps = 0;
+	f.probeSolved = false;
+	f.probeTime = 0.0f;
+	if (openCells > 0 && probeStepLimit > 0)
+	{
+		Timer probeTimer;
+		probeTimer.Reset();
+		BacktrackSearch probe;
+		probe.SetStepLimit(probeStepLimit);
+		f.probeSolved = probe.Solve(board, PROBE_MAX_TIME);
+		f.probeSteps = probe.GetStepCount();
+		f.probeTime = probeTimer.Elapsed();
+		if (f.probeSolved)
+			probeSolution.Copy(probe.GetSolution());
+	}
+	return f;
+}
+
+SolverRoute ChooseRoute(const DifficultyFeatures& f, int hardwareThreads)
+{
+	if (f.fixedCells == f.numCells)
+		return ROUTE_PROPAGATION;
+	if (f.probeSolved)
+		return ROUTE_PROBE;
+	if (f.order <= 3)
+		return ROUTE_BACKTRACK;
+	if (f.fixedRatio >= WELL_CONSTRAINED_RATIO || f.meanCandidates <= LOW_BRANCHING)
+		return ROUTE_BACKTRACK;
+	if (f.order >= 5 && hardwareThreads > 1)
+		return ROUTE_PARALLEL_ACS;
+	return ROUTE_ACS;
+}
+
+int RouteAlgorithm(SolverRoute route)
+{
+	switch (route)
+	{
+	case ROUTE_ACS:
+		return 0;
+	case ROUTE_PARALLEL_ACS:
+		return 2;
+	case ROUTE_PROPAGATION:
+	case ROUTE_PROBE:
+	case ROUTE_BACKTRACK:
+	default:
+		return 1;
+	}
+}
+
+const char* RouteName(SolverRoute route)
+{
+	switch (route)
+	{
+	case ROUTE_PROPAGATION: return "propagation";
+	case ROUTE_PROBE: return "probe";
+	case ROUTE_BACKTRACK: return "backtrack";
+	case ROUTE_ACS: return "acs";
+	case ROUTE_PARALLEL_ACS: return "parallel_acs";
+	}
+	return "unknown";
+}
+
+void LogRoute(const string& fileName, const DifficultyFeatures& f, SolverRoute route, bool success, float solTime)
+{
+	bool writeHeader;
+	{
+		ifstream existing(fileName);
+		writeHeader = !existing.good() || existing.peek() == ifstream::traits_type::eof();
+	}
+	ofstream out(fileName, ios::app);
+	if (!out.is_open())
+	{
+		cerr << "could not open route log: " << fileName << endl;
+		return;
+	}
+	if (writeHeader)
+		out << "order,cells,fixed,fixed_ratio,mean_candidates,histogram,probe_steps,probe_solved,probe_time,route,success,time" << endl;
+
+	out << f.order << "," << f.numCells << "," << f.fixedCells << "," << f.fixedRatio << "," << f.meanCandidates << ",";
+	// histogram as count:cells pairs, skipping empty buckets
+	bool first = true;
+	for (size_t k = 0; k < f.candidateHistogram.size(); k++)
+	{
+		if (f.candidateHistogram[k] == 0)
+			continue;
+		if (!first)
+			out << ";";
+		out << k << ":" << f.candidateHistogram[k];
+		first = false;
+	}
+	out << "," << f.probeSteps << "," << (f.probeSolved ? 1 : 0) << "," << f.probeTime << "," << RouteName(route)
+	    << "," << (success ? 1 : 0) << "," << solTime << endl;
+}
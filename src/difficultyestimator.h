@@ -0,0 +1,74 @@
+#pragma once
+/*******************************************************************************
+ * DIFFICULTY ESTIMATOR - Pre-solve analysis and automatic algorithm routing
+ *
+ * Computes a few cheap features of the propagated puzzle and uses them to pick
+ * a solving algorithm (--alg auto):
+ *
+ * - Fixed cell ratio after the initial constraint propagation
+ * - Histogram of candidate counts over the unfixed cells
+ * - Result of a short, step-limited backtracking probe
+ *
+ * The features and the decision can be appended to a CSV log so that the
+ * routing thresholds can be re-fitted on real traffic.
+ ******************************************************************************/
+
+#include "board.h"
+#include <string>
+#include <vector>
+using namespace std;
+
+// Possible routing decisions
+enum SolverRoute
+{
+	ROUTE_PROPAGATION,	// constraint propagation already solved the puzzle
+	ROUTE_PROBE,		// the probe search solved the puzzle
+	ROUTE_BACKTRACK,	// well-constrained: use backtracking (alg 1)
+	ROUTE_ACS,			// use single-threaded ACS (alg 0)
+	ROUTE_PARALLEL_ACS	// sparse large instance: use parallel ACS (alg 2)
+};
+
+struct DifficultyFeatures
+{
+	int order;
+	int numCells;
+	int fixedCells;
+	float fixedRatio;			// fixed cells / total cells
+	float meanCandidates;		// mean candidate count over unfixed cells
+	vector<int> candidateHistogram;	// [k] = number of unfixed cells with k candidates
+	int probeSteps;				// steps used by the probe search
+	bool probeSolved;			// the probe found a complete solution
+	float probeTime;			// seconds spent in the probe
+};
+
+/*******************************************************************************
+ * EstimateDifficulty
+ *
+ * Extracts the features from a propagated board and runs a backtracking probe
+ * limited to probeStepLimit steps. If the probe solves the puzzle its solution
+ * is copied to probeSolution.
+ ******************************************************************************/
+DifficultyFeatures EstimateDifficulty(const Board& board, int probeStepLimit, Board& probeSolution);
+
+/*******************************************************************************
+ * ChooseRoute
+ *
+ * Maps the features to a routing decision. hardwareThreads is used to decide
+ * between single-threaded and parallel ACS for sparse large instances.
+ ******************************************************************************/
+SolverRoute ChooseRoute(const DifficultyFeatures& features, int hardwareThreads);
+
+// Algorithm number (as used by --alg) for a route
+int RouteAlgorithm(SolverRoute route);
+
+// Short name of a route, used for logging
+const char* RouteName(SolverRoute route);
+
+/*******************************************************************************
+ * LogRoute
+ *
+ * Appends one CSV line with the features and the decision to fileName, writing
+ * a header first if the file is new. The outcome columns (success, time) are
+ * filled in by the caller after solving.
+ ******************************************************************************/
+void LogRoute(const string& fileName, const DifficultyFeatures& features, SolverRoute route, bool success, float solTime);
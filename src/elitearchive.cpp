@@ -0,0 +1,100 @@
+/*******************************************************************************
+ * ELITE ARCHIVE - Implementation
+ ******************************************************************************/
+
+#include "elitearchive.h"
+
+void EliteArchive::Configure(int newCapacity, int newMinDistance)
+{
+	capacity = newCapacity;
+	minDistance = newMinDistance;
+	count = 0;
+}
+
+void EliteArchive::Reset(const Board& puzzle)
+{
+	count = 0;
+	if ((int)elites.size() < capacity)
+	{
+		elites.resize(capacity);
+		scores.resize(capacity);
+		hashes.resize(capacity);
+	}
+	// size every board's cell buffer now, so Offer() does not allocate
+	for (int k = 0; k < capacity; k++)
+		elites[k].Copy(puzzle);
+}
+
+// number of cells where a and b differ, counting stops at limit
+int EliteArchive::Distance(const Board& a, const Board& b, int limit) const
+{
+	int distance = 0;
+	for (int i = 0; i < a.CellCount() && distance < limit; i++)
+		distance += (a.GetCell(i).GetBits() != b.GetCell(i).GetBits());
+	return distance;
+}
+
+void EliteArchive::Store(int slot, const Board& solution, int score)
+{
+	elites[slot].Copy(solution);
+	scores[slot] = score;
+	hashes[slot] = solution.Hash();
+}
+
+bool EliteArchive::Offer(const Board& solution, int score)
+{
+	if (capacity == 0)
+		return false;
+
+	int worst = -1;
+	for (int k = 0; k < count; k++)
+	{
+		if (worst == -1 || scores[k] < scores[worst])
+			worst = k;
+	}
+	// a full archive only takes solutions better than its worst elite
+	if (count == capacity && score <= scores[worst])
+		return false;
+
+	uint64_t hash = solution.Hash();
+	int nearest = -1;
+	int nearestDistance = minDistance;
+	for (int k = 0; k < count; k++)
+	{
+		if (hashes[k] == hash && scores[k] == score)
+			return false;	// already archived
+		int d = Distance(solution, elites[k], nearestDistance);
+		if (d < nearestDistance)
+		{
+			nearest = k;
+			nearestDistance = d;
+		}
+	}
+
+	if (nearest != -1)
+	{
+		// too close to an elite: replace it only if better
+		if (score <= scores[nearest])
+			return false;
+		Store(nearest, solution, score);
+		return true;
+	}
+	if (count < capacity)
+	{
+		Store(count++, solution, score);
+		return true;
+	}
+	Store(worst, solution, score);
+	return true;
+}
+
+int EliteArchive::Best() const
+{
+	int best = -1;
+	for (int k = 0; k < count; k++)
+	{
+		if (best == -1 || scores[k] > scores[best])
+			best = k;
+	}
+	return best;
+}
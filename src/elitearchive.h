@@ -0,0 +1,52 @@
+#pragma once
+/*******************************************************************************
+ * ELITE ARCHIVE - Bounded set of good, mutually distant partial solutions
+ *
+ * A colony only remembers its best-so-far and its iteration-best, so a good
+ * solution in another region of the search space is lost as soon as a
+ * better one turns up. The archive keeps up to capacity solutions such that:
+ * - no two have the same fixed cells (Board::Hash)
+ * - no two are closer than minDistance cells (Hamming distance over the
+ *   cell values); a candidate too close to an elite replaces it only if it
+ *   is better (crowding)
+ * - when full, a distant candidate replaces the worst elite if it is better
+ *
+ * The best elite is only ever replaced by a better solution, so the archive
+ * also keeps the best solution seen by the colony.
+ ******************************************************************************/
+
+#include "board.h"
+#include <vector>
+#include <cstdint>
+
+class EliteArchive
+{
+	int capacity;
+	int minDistance;	// in cells
+	int count;
+	std::vector<Board> elites;	// first count entries are in use
+	std::vector<int> scores;
+	std::vector<uint64_t> hashes;
+
+	int Distance(const Board& a, const Board& b, int limit) const;
+	void Store(int slot, const Board& solution, int score);
+
+public:
+	EliteArchive() : capacity(0), minDistance(0), count(0) {}
+
+	// at most capacity elites (0 = archive off), at least minDistance cells apart
+	void Configure(int capacity, int minDistance);
+	// empty the archive; the boards are sized for puzzle (grow only)
+	void Reset(const Board& puzzle);
+
+	// offer a solution; returns true if it was added to the archive
+	bool Offer(const Board& solution, int score);
+
+	bool Enabled() const { return capacity > 0; }
+	int Size() const { return count; }
+	const Board& Get(int k) const { return elites[k]; }
+	int Score(int k) const { return scores[k]; }
+	uint64_t Hash(int k) const { return hashes[k]; }
+	// index of the best elite, -1 if the archive is empty
+	int Best() const;
+};
@@ -0,0 +1,115 @@
+/*******************************************************************************
+ * EXACT FINISHER - Implementation
+ ******************************************************************************/
+
+#include "exactfinisher.h"
+#include "backtracksearch.h"
+#include "constraintpropagation.h"
+#include <vector>
+
+// size of the transposition table: 2^15 entries (256 KB)
+static const int FINISHER_TABLE_BITS = 15;
+
+ExactFinisher::ExactFinisher(float maxTime, int stepLimit)
+	: maxTime(maxTime), stepLimit(stepLimit), running(false), succeeded(false), cancel(false), attempts(0)
+{
+	search.SetStepLimit(stepLimit);
+	search.SetCancelFlag(&cancel);
+	search.SetTranspositionTable(FINISHER_TABLE_BITS);
+}
+
+ExactFinisher::~ExactFinisher()
+{
+	Stop();
+}
+
+void ExactFinisher::Reset()
+{
+	Stop();
+	succeeded.store(false);
+	attempts.store(0);
+	search.ClearTranspositionTable();
+}
+
+/*******************************************************************************
+ * BuildReducedPuzzle - Keep the ant's assignment away from the conflicts
+ *
+ * Every empty cell of the partial solution is released together with its
+ * row, column and box. The remaining assigned cells are set on a copy of the
+ * puzzle with constraint propagation. Returns false if this already leads to
+ * a contradiction.
+ ******************************************************************************/
+bool ExactFinisher::BuildReducedPuzzle(const Board& puzzle, const Board& partial)
+{
+	int numCells = puzzle.CellCount();
+	int numUnits = puzzle.GetNumUnits();
+	std::vector<bool> release(numCells, false);
+
+	for (int i = 0; i < numCells; i++)
+	{
+		if (!partial.GetCell(i).Empty())
+			continue;
+		int iRow = puzzle.RowForCell(i);
+		int iCol = puzzle.ColForCell(i);
+		int iBox = puzzle.BoxForCell(i);
+		for (int j = 0; j < numUnits; j++)
+		{
+			release[puzzle.RowCell(iRow, j)] = true;
+			release[puzzle.ColCell(iCol, j)] = true;
+			release[puzzle.BoxCell(iBox, j)] = true;
+		}
+	}
+
+	reduced.Copy(puzzle);
+	for (int i = 0; i < numCells; i++)
+	{
+		const ValueSet& value = partial.GetCell(i);
+		if (release[i] || !value.Fixed() || reduced.GetCell(i).Fixed())
+			continue;
+		// an earlier placement may already have ruled this value out
+		if (!reduced.GetCell(i).Contains(value))
+			continue;
+		SetCellAndPropagate(reduced, i, value);
+	}
+	return reduced.InfeasibleCellCount() == 0;
+}
+
+void ExactFinisher::Run()
+{
+	if (search.Solve(reduced, maxTime))
+	{
+		solution.Copy(search.GetSolution());
+		succeeded.store(true);
+	}
+	running.store(false);
+}
+
+bool ExactFinisher::Launch(const Board& puzzle, const Board& partial)
+{
+	std::unique_lock<std::mutex> lock(launchMutex, std::try_to_lock);
+	if (!lock.owns_lock() || running.load() || succeeded.load())
+		return false;
+
+	// previous attempt has finished, reclaim its thread
+	if (worker.joinable())
+		worker.join();
+
+	attempts.fetch_add(1);
+	if (!BuildReducedPuzzle(puzzle, partial))
+		return true;
+
+	running.store(true);
+	worker = std::thread(&ExactFinisher::Run, this);
+	return true;
+}
+
+void ExactFinisher::Stop()
+{
+	cancel.store(true);
+	{
+		std::lock_guard<std::mutex> lock(launchMutex);
+		if (worker.joinable())
+			worker.join();
+	}
+	cancel.store(false);
+}
@@ -0,0 +1,60 @@
+#pragma once
+/*******************************************************************************
+ * EXACT FINISHER - Bounded exact search on near-complete ant solutions
+ *
+ * When the best ant solution is only a few cells short of complete, the ACS
+ * can spend a long time closing the gap. The finisher takes the partial
+ * solution, releases the cells in conflict (empty cells) together with every
+ * cell in their rows, columns and boxes, keeps the rest of the ant's
+ * assignment and runs a step- and time-limited backtracking search on the
+ * remainder in a helper thread.
+ *
+ * The ant system polls Succeeded() once per iteration and stops as soon as the
+ * finisher has found a complete solution.
+ *
+ * Successive attempts often start from the same or overlapping reduced
+ * puzzles, so the search keeps a transposition table of exhausted nodes
+ * (by Board::Hash) from one attempt to the next, until Reset().
+ ******************************************************************************/
+
+#include "board.h"
+#include "backtracksearch.h"
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+class ExactFinisher
+{
+	float maxTime;		// time limit for each finishing attempt
+	int stepLimit;		// backtracking step limit for each attempt (0 = none)
+	std::thread worker;
+	std::mutex launchMutex;
+	std::atomic<bool> running;
+	std::atomic<bool> succeeded;
+	std::atomic<bool> cancel;
+	std::atomic<int> attempts;
+	Board reduced;		// puzzle + kept part of the ant solution
+	Board solution;
+	BacktrackSearch search;	// reused by all attempts on one puzzle
+
+	void Run();
+	bool BuildReducedPuzzle(const Board& puzzle, const Board& partial);
+
+public:
+	ExactFinisher(float maxTime, int stepLimit);
+	~ExactFinisher();
+
+	// Reset state before a new solve
+	void Reset();
+	// Start an attempt on partial (a solution of puzzle with empty cells).
+	// Returns false if an attempt is already running.
+	bool Launch(const Board& puzzle, const Board& partial);
+	// Cancel any running attempt and wait for the helper thread
+	void Stop();
+
+	bool Succeeded() const { return succeeded.load(); }
+	const Board& GetSolution() const { return solution; }
+	int GetAttempts() const { return attempts.load(); }
+	// attempts and subtrees cut short by the transposition table
+	int GetTranspositionHits() { return search.GetTranspositionHits(); }
+};
@@ -0,0 +1,73 @@
+/*******************************************************************************
+ * FAILURE HEATMAP - Implementation
+ ******************************************************************************/
+
+#include "failureheatmap.h"
+#include <algorithm>
+
+void FailureHeatmap::Configure(bool on, float newDecay, float newStartBias)
+{
+	enabled = on;
+	decay = newDecay;
+	startBias = newStartBias;
+}
+
+void FailureHeatmap::Reset(int cells)
+{
+	numCells = cells;
+	iterations = 0;
+	if ((int)heat.size() < cells)
+	{
+		heat.resize(cells);
+		cumulative.resize(cells);
+		hot.resize(cells);
+		hotCells.reserve(cells);
+	}
+	std::fill(heat.begin(), heat.begin() + cells, 0.0f);
+	Commit();
+}
+
+void FailureHeatmap::Decay()
+{
+	for (int i = 0; i < numCells; i++)
+		heat[i] *= decay;
+	++iterations;
+}
+
+void FailureHeatmap::Commit()
+{
+	// the floor keeps every cell possible: half the mass is spread evenly
+	float total = 0.0f;
+	for (int i = 0; i < numCells; i++)
+		total += heat[i];
+	float floor = (total > 0.0f) ? total / numCells : 1.0f;
+	float sum = 0.0f;
+	for (int i = 0; i < numCells; i++)
+	{
+		sum += heat[i] + floor;
+		cumulative[i] = sum;
+	}
+
+	// hot cells for the heat order; none while nothing has failed
+	float mean = total / numCells;
+	hotCells.clear();
+	for (int i = 0; i < numCells; i++)
+	{
+		hot[i] = (total > 0.0f && heat[i] > mean);
+		if (hot[i])
+			hotCells.push_back(i);
+	}
+	// ties in cell order; std::sort, unlike stable_sort, does not allocate
+	std::sort(hotCells.begin(), hotCells.end(),
+		[this](int a, int b) { return heat[a] > heat[b] || (heat[a] == heat[b] && a < b); });
+}
+
+int FailureHeatmap::DrawStartCell(std::mt19937& randGen, std::uniform_int_distribution<int>& uniformCell,
+	std::uniform_real_distribution<float>& unit)
+{
+	if (startBias <= 0.0f || unit(randGen) >= startBias)
+		return uniformCell(randGen);
+	float r = unit(randGen) * cumulative[numCells - 1];
+	int cell = (int)(std::upper_bound(cumulative.begin(), cumulative.begin() + numCells, r) - cumulative.begin());
+	return std::min(cell, numCells - 1);
+}
@@ -0,0 +1,63 @@
+#pragma once
+/*******************************************************************************
+ * FAILURE HEATMAP - Decaying count of where the ants fail
+ *
+ * After every iteration each cell's heat is multiplied by decay and then
+ * raised by the fraction of the iteration's ants whose solution left the cell
+ * empty, so heat is a running average of the failure rate over roughly
+ * 1 / (1 - decay) iterations. Cells that keep failing are the contested
+ * regions of the puzzle.
+ *
+ * The colony draws ant start cells from the heatmap: with probability
+ * startBias a start cell is drawn in proportion to heat (plus a floor, so
+ * every cell stays possible), otherwise uniformly. The sequential order then
+ * starts in a contested region, while the rest of the board is still open.
+ *
+ * The heat cell order (--antorder heat) does this for every ant: the cells
+ * hotter than the mean are visited first, hottest first, then the others in
+ * the sequential order from the ant's start cell.
+ ******************************************************************************/
+
+#include <vector>
+#include <random>
+#include <cstdint>
+
+class FailureHeatmap
+{
+	bool enabled;
+	float decay;
+	float startBias;			// share of the start cells drawn from the heatmap (0 = off)
+	std::vector<float> heat;
+	std::vector<float> cumulative;	// running sum of heat + floor, for the draws
+	std::vector<int> hotCells;		// cells hotter than the mean, hottest first
+	std::vector<uint8_t> hot;		// cell is in hotCells
+	int numCells;
+	int iterations;
+
+public:
+	FailureHeatmap() : enabled(false), decay(0.95f), startBias(0.0f), numCells(0), iterations(0) {}
+
+	void Configure(bool enabled, float decay, float startBias);
+	bool Enabled() const { return enabled; }
+	// zero the heat of numCells cells (grow only)
+	void Reset(int numCells);
+	float StartBias() const { return startBias; }
+
+	// begin an iteration's update: decay every cell
+	void Decay();
+	// ant failures: add weight to cell (weight = 1 / number of ants)
+	void AddFailure(int cell, float weight) { heat[cell] += weight; }
+	// end an iteration's update: rebuild the table for DrawStartCell
+	void Commit();
+
+	// start cell: biased by heat with probability startBias, uniform otherwise
+	int DrawStartCell(std::mt19937& randGen, std::uniform_int_distribution<int>& uniformCell,
+		std::uniform_real_distribution<float>& unit);
+
+	int CellCount() const { return numCells; }
+	float Heat(int cell) const { return heat[cell]; }
+	// cells hotter than the mean, hottest first, as of the last Commit
+	const std::vector<int>& HotCells() const { return hotCells; }
+	bool IsHot(int cell) const { return hot[cell] != 0; }
+	int Iterations() const { return iterations; }
+};
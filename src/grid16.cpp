@@ -0,0 +1,452 @@
+/*******************************************************************************
+ * GRID16 - Implementation
+ ******************************************************************************/
+
+#include "grid16.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// number of bits set in a 32-bit word (Knuth, 'Sideways Addition')
+static inline int BitCount32(uint32_t x)
+{
+	x = x - ((x >> 1) & 0x55555555u);
+	x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+	x = (x + (x >> 4)) & 0x0f0f0f0fu;
+	return (int)((x * 0x01010101u) >> 24);
+}
+
+#ifdef __AVX2__
+
+// 0xFFFF in the lanes of x that hold exactly one value, 0 elsewhere
+static inline __m256i SingleLanes(__m256i x)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i lowCleared = _mm256_and_si256(x, _mm256_sub_epi16(x, _mm256_set1_epi16(1)));
+	return _mm256_andnot_si256(_mm256_cmpeq_epi16(x, zero), _mm256_cmpeq_epi16(lowCleared, zero));
+}
+
+// x with one lane cleared
+static inline __m256i DropLane(__m256i x, int lane)
+{
+	const __m256i index = _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+	return _mm256_andnot_si256(_mm256_cmpeq_epi16(index, _mm256_set1_epi16((short)lane)), x);
+}
+
+// the box whose top left cell is corner, as 16 lanes (same order as Board::BoxCell)
+static inline __m256i LoadBox(const uint16_t *corner)
+{
+	__m128i lo = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)corner), _mm_loadl_epi64((const __m128i*)(corner + 16)));
+	__m128i hi = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(corner + 32)), _mm_loadl_epi64((const __m128i*)(corner + 48)));
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+static inline __m256i Load(const uint16_t *p) { return _mm256_loadu_si256((const __m256i*)p); }
+
+// add x to a seen once / seen twice pair, lane by lane
+static inline void Accumulate(__m256i& seen, __m256i& twice, __m256i x)
+{
+	twice = _mm256_or_si256(twice, _mm256_and_si256(seen, x));
+	seen = _mm256_or_si256(seen, x);
+}
+
+// OR of the 16 lanes of x
+static inline uint16_t HorizontalOr(__m256i x)
+{
+	__m128i v = _mm_or_si128(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+	v = _mm_or_si128(v, _mm_srli_si128(v, 8));
+	v = _mm_or_si128(v, _mm_srli_si128(v, 4));
+	v = _mm_or_si128(v, _mm_srli_si128(v, 2));
+	return (uint16_t)_mm_cvtsi128_si32(v);
+}
+
+// merge the seen/twice pair shifted down by BYTES into itself
+template <int BYTES>
+static inline void Fold(__m128i& seen, __m128i& twice)
+{
+	__m128i s = _mm_srli_si128(seen, BYTES);
+	__m128i t = _mm_srli_si128(twice, BYTES);
+	twice = _mm_or_si128(_mm_or_si128(twice, t), _mm_and_si128(seen, s));
+	seen = _mm_or_si128(seen, s);
+}
+
+// values held by at least one / at least two of the 16 lanes of x
+static inline void HorizontalOnce(__m256i x, uint16_t& seen, uint16_t& twice)
+{
+	__m128i lo = _mm256_castsi256_si128(x);
+	__m128i hi = _mm256_extracti128_si256(x, 1);
+	__m128i s = _mm_or_si128(lo, hi);
+	__m128i t = _mm_and_si128(lo, hi);
+	Fold<8>(s, t);
+	Fold<4>(s, t);
+	Fold<2>(s, t);
+	seen = (uint16_t)_mm_cvtsi128_si32(s);
+	twice = (uint16_t)_mm_cvtsi128_si32(t);
+}
+
+// Column-wise seen/twice of the 4 rows of a band to per-box values: the 4
+// lanes of each box are folded within their 64-bit group, then broadcast
+static inline void FoldBoxes(__m256i& seen, __m256i& twice)
+{
+	__m256i s = _mm256_srli_epi64(seen, 16), t = _mm256_srli_epi64(twice, 16);
+	twice = _mm256_or_si256(_mm256_or_si256(twice, t), _mm256_and_si256(seen, s));
+	seen = _mm256_or_si256(seen, s);
+	s = _mm256_srli_epi64(seen, 32);
+	t = _mm256_srli_epi64(twice, 32);
+	twice = _mm256_or_si256(_mm256_or_si256(twice, t), _mm256_and_si256(seen, s));
+	seen = _mm256_or_si256(seen, s);
+	seen = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(seen, 0), 0);
+	twice = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(twice, 0), 0);
+}
+
+// number of candidates per lane (nibble table lookup)
+static inline __m256i CountLanes(__m256i x)
+{
+	const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+	                                       0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i nibble = _mm256_set1_epi8(0x0f);
+	__m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(x, nibble)),
+	                                _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble)));
+	return _mm256_add_epi16(_mm256_and_si256(bytes, _mm256_set1_epi16(0x00ff)), _mm256_srli_epi16(bytes, 8));
+}
+
+#endif
+
+void Grid16::Transpose()
+{
+	for (int r = 0; r < 16; r++)
+		for (int c = 0; c < 16; c++)
+			cellsT[c * 16 + r] = cells[r * 16 + c];
+}
+
+void Grid16::FromBoard(const Board& board)
+{
+	for (int i = 0; i < 256; i++)
+		cells[i] = (uint16_t)board.GetCell(i).GetBits();
+	Transpose();
+	numFixed = board.FixedCellCount();
+	numInfeasible = board.InfeasibleCellCount();
+	cpCalls = 0;
+}
+
+void Grid16::ToBoard(const Board& puzzle, Board& out) const
+{
+	out.Copy(puzzle);
+	for (int i = 0; i < 256; i++)
+		out.SetCellDirect(i, ValueSet(16, cells[i]));
+	for (int k = puzzle.FixedCellCount(); k < numFixed; k++)
+		out.IncrementFixedCells();
+	for (int k = puzzle.InfeasibleCellCount(); k < numInfeasible; k++)
+		out.IncrementInfeasible();
+}
+
+// union of the fixed values among the row, column and box peers of cell
+uint16_t Grid16::PeerFixedValues(int cell) const
+{
+	int r = cell >> 4, c = cell & 15;
+	const uint16_t *corner = &cells[(r & ~3) * 16 + (c & ~3)];
+#ifdef __AVX2__
+	__m256i row = DropLane(Load(&cells[r * 16]), c);
+	__m256i col = DropLane(Load(&cellsT[c * 16]), r);
+	__m256i box = DropLane(LoadBox(corner), (r & 3) * 4 + (c & 3));
+	__m256i fixedValues = _mm256_or_si256(_mm256_and_si256(row, SingleLanes(row)),
+	                      _mm256_or_si256(_mm256_and_si256(col, SingleLanes(col)),
+	                                      _mm256_and_si256(box, SingleLanes(box))));
+	return HorizontalOr(fixedValues);
+#else
+	uint16_t fixedPeers = 0;
+	for (int j = 0; j < 16; j++)
+	{
+		uint16_t v;
+		if (j != c && IsFixed(v = cells[r * 16 + j]))
+			fixedPeers |= v;
+		if (j != r && IsFixed(v = cellsT[c * 16 + j]))
+			fixedPeers |= v;
+		if (j != (r & 3) * 4 + (c & 3) && IsFixed(v = corner[(j >> 2) * 16 + (j & 3)]))
+			fixedPeers |= v;
+	}
+	return fixedPeers;
+#endif
+}
+
+// union of the candidates of the row, column and box peers of cell, per unit
+void Grid16::PeerValues(int cell, uint16_t& rowAll, uint16_t& colAll, uint16_t& boxAll) const
+{
+	int r = cell >> 4, c = cell & 15;
+	const uint16_t *corner = &cells[(r & ~3) * 16 + (c & ~3)];
+#ifdef __AVX2__
+	rowAll = HorizontalOr(DropLane(Load(&cells[r * 16]), c));
+	colAll = HorizontalOr(DropLane(Load(&cellsT[c * 16]), r));
+	boxAll = HorizontalOr(DropLane(LoadBox(corner), (r & 3) * 4 + (c & 3)));
+#else
+	rowAll = colAll = boxAll = 0;
+	for (int j = 0; j < 16; j++)
+	{
+		if (j != c)
+			rowAll |= cells[r * 16 + j];
+		if (j != r)
+			colAll |= cellsT[c * 16 + j];
+		if (j != (r & 3) * 4 + (c & 3))
+			boxAll |= corner[(j >> 2) * 16 + (j & 3)];
+	}
+#endif
+}
+
+/*******************************************************************************
+ * SetCellAndPropagate / PropagateCell
+ *
+ * The cascade of constraintpropagation.cpp: setting a cell visits the box,
+ * column and row peers interleaved in unit order; each peer applies
+ * elimination, and then the hidden single rule (row, column, box) if it is
+ * still open. Only the peer reductions differ, so the cells, the counters
+ * and the number of calls match a Board run exactly.
+ ******************************************************************************/
+void Grid16::SetCellAndPropagate(int cell, uint16_t value)
+{
+	if (IsFixed(cells[cell]))
+		return;
+	Set(cell, value);
+	numFixed++;
+	cpCalls++;
+
+	int r = cell >> 4, c = cell & 15;
+	int corner = (r & ~3) * 16 + (c & ~3);
+	for (int j = 0; j < 16; j++)
+	{
+		int box = corner + (j >> 2) * 16 + (j & 3);
+		int col = j * 16 + c;
+		int row = r * 16 + j;
+		if (box != cell)
+			PropagateCell(box);
+		if (col != cell)
+			PropagateCell(col);
+		if (row != cell)
+			PropagateCell(row);
+	}
+}
+
+void Grid16::PropagateCell(int cell)
+{
+	uint16_t x = cells[cell];
+	if (x == 0 || IsFixed(x))
+		return;
+
+	// Rule 1: elimination of the values fixed in the peers
+	uint16_t allowed = (uint16_t)~PeerFixedValues(cell);
+	if (IsFixed(allowed))
+	{
+		SetCellAndPropagate(cell, allowed);
+		return;
+	}
+	x &= allowed;
+	Set(cell, x);
+
+	// Rule 2: hidden single in the row, column or box
+	if (x != 0 && !IsFixed(x))
+	{
+		uint16_t rowAll, colAll, boxAll;
+		PeerValues(cell, rowAll, colAll, boxAll);
+		if (IsFixed(x & ~rowAll))
+			SetCellAndPropagate(cell, x & ~rowAll);
+		else if (IsFixed(x & ~colAll))
+			SetCellAndPropagate(cell, x & ~colAll);
+		else if (IsFixed(x & ~boxAll))
+			SetCellAndPropagate(cell, x & ~boxAll);
+	}
+
+	if (cells[cell] == 0)
+		numInfeasible++;
+}
+
+/*******************************************************************************
+ * Propagate
+ *
+ * Each pass reduces all 48 units from the current cells, then updates every
+ * open cell from its three units at once: the fixed values of the units are
+ * eliminated, and a value that only this cell holds in one of its units
+ * fixes it (two such values empty it). Passes repeat until nothing changes.
+ * A contradiction is an empty cell, a unit missing a value or a value fixed
+ * twice in a unit. On success the fixed count is exact and the infeasible
+ * count is zero.
+ ******************************************************************************/
+bool Grid16::Propagate()
+{
+#ifdef __AVX2__
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i full = _mm256_set1_epi16(-1);
+	for (;;)
+	{
+		__m256i row[16];
+		uint16_t rowFixed[16], rowOnce[16];
+		__m256i boxFixed[4], boxOnce[4];
+		__m256i colSeen = zero, colTwice = zero, colFixed = zero, colFixedTwice = zero;
+		__m256i bad = zero;
+		for (int band = 0; band < 4; band++)
+		{
+			__m256i bandSeen = zero, bandTwice = zero, bandFixed = zero, bandFixedTwice = zero;
+			for (int k = 0; k < 4; k++)
+			{
+				int r = band * 4 + k;
+				__m256i x = row[r] = Load(&cells[r * 16]);
+				__m256i fixedX = _mm256_and_si256(x, SingleLanes(x));
+				bad = _mm256_or_si256(bad, _mm256_cmpeq_epi16(x, zero));
+				Accumulate(colSeen, colTwice, x);
+				Accumulate(colFixed, colFixedTwice, fixedX);
+				Accumulate(bandSeen, bandTwice, x);
+				Accumulate(bandFixed, bandFixedTwice, fixedX);
+
+				uint16_t seen, twice, fixedSeen, fixedTwice;
+				HorizontalOnce(x, seen, twice);
+				HorizontalOnce(fixedX, fixedSeen, fixedTwice);
+				if (seen != 0xFFFF || fixedTwice != 0)
+					return false;
+				rowFixed[r] = fixedSeen;
+				rowOnce[r] = seen & ~twice;
+			}
+			FoldBoxes(bandSeen, bandTwice);
+			FoldBoxes(bandFixed, bandFixedTwice);
+			bad = _mm256_or_si256(bad, _mm256_or_si256(_mm256_xor_si256(bandSeen, full), bandFixedTwice));
+			boxFixed[band] = bandFixed;
+			boxOnce[band] = _mm256_andnot_si256(bandTwice, bandSeen);
+		}
+		bad = _mm256_or_si256(bad, _mm256_or_si256(_mm256_xor_si256(colSeen, full), colFixedTwice));
+		if (!_mm256_testz_si256(bad, bad))
+			return false;
+		__m256i colOnce = _mm256_andnot_si256(colTwice, colSeen);
+
+		__m256i changed = zero;
+		int fixedCells = 0;
+		for (int r = 0; r < 16; r++)
+		{
+			__m256i x = row[r];
+			__m256i single = SingleLanes(x);
+			__m256i eliminate = _mm256_or_si256(_mm256_set1_epi16((short)rowFixed[r]), _mm256_or_si256(colFixed, boxFixed[r >> 2]));
+			__m256i y = _mm256_andnot_si256(_mm256_andnot_si256(single, eliminate), x);
+			__m256i once = _mm256_or_si256(_mm256_set1_epi16((short)rowOnce[r]), _mm256_or_si256(colOnce, boxOnce[r >> 2]));
+			__m256i hidden = _mm256_andnot_si256(single, _mm256_and_si256(y, once));
+			__m256i hit = _mm256_xor_si256(_mm256_cmpeq_epi16(hidden, zero), full);
+			y = _mm256_blendv_epi8(y, _mm256_and_si256(hidden, SingleLanes(hidden)), hit);
+			changed = _mm256_or_si256(changed, _mm256_xor_si256(x, y));
+			fixedCells += BitCount32((uint32_t)_mm256_movemask_epi8(SingleLanes(y))) / 2;
+			_mm256_storeu_si256((__m256i*)&cells[r * 16], y);
+		}
+		if (_mm256_testz_si256(changed, changed))
+		{
+			numFixed = fixedCells;
+			break;
+		}
+	}
+#else
+	for (;;)
+	{
+		// units 0-15 are the rows, 16-31 the columns and 32-47 the boxes
+		uint16_t seen[48] = {0}, twice[48] = {0}, fixedSeen[48] = {0}, fixedTwice[48] = {0};
+		for (int i = 0; i < 256; i++)
+		{
+			uint16_t x = cells[i];
+			if (x == 0)
+				return false;
+			uint16_t f = IsFixed(x) ? x : 0;
+			int units[3] = { i >> 4, 16 + (i & 15), 32 + (i >> 6) * 4 + ((i & 15) >> 2) };
+			for (int t = 0; t < 3; t++)
+			{
+				int u = units[t];
+				twice[u] |= seen[u] & x;
+				seen[u] |= x;
+				fixedTwice[u] |= fixedSeen[u] & f;
+				fixedSeen[u] |= f;
+			}
+		}
+		for (int u = 0; u < 48; u++)
+		{
+			if (seen[u] != 0xFFFF || fixedTwice[u] != 0)
+				return false;
+		}
+
+		bool changed = false;
+		int fixedCells = 0;
+		for (int i = 0; i < 256; i++)
+		{
+			uint16_t x = cells[i];
+			if (!IsFixed(x))
+			{
+				int units[3] = { i >> 4, 16 + (i & 15), 32 + (i >> 6) * 4 + ((i & 15) >> 2) };
+				uint16_t eliminate = 0, once = 0;
+				for (int t = 0; t < 3; t++)
+				{
+					eliminate |= fixedSeen[units[t]];
+					once |= seen[units[t]] & ~twice[units[t]];
+				}
+				uint16_t y = x & ~eliminate;
+				uint16_t hidden = y & once;
+				if (hidden != 0)
+					y = IsFixed(hidden) ? hidden : 0;
+				if (y != x)
+				{
+					cells[i] = y;
+					changed = true;
+				}
+			}
+			fixedCells += IsFixed(cells[i]);
+		}
+		if (!changed)
+		{
+			numFixed = fixedCells;
+			break;
+		}
+	}
+#endif
+	numInfeasible = 0;
+	Transpose();
+	return true;
+}
+
+int Grid16::MostConstrainedCell() const
+{
+#ifdef __AVX2__
+	// fixed cells count as 0xFFFF so they never hold the minimum
+	__m256i counts[16];
+	__m256i least = _mm256_set1_epi16(-1);
+	for (int r = 0; r < 16; r++)
+	{
+		__m256i x = Load(&cells[r * 16]);
+		counts[r] = _mm256_or_si256(CountLanes(x), SingleLanes(x));
+		least = _mm256_min_epu16(least, counts[r]);
+	}
+	__m128i m = _mm_min_epu16(_mm256_castsi256_si128(least), _mm256_extracti128_si256(least, 1));
+	int minCount = _mm_cvtsi128_si32(_mm_minpos_epu16(m)) & 0xFFFF;
+	if (minCount == 0xFFFF)
+		return -1;
+	__m256i target = _mm256_set1_epi16((short)minCount);
+	for (int r = 0; r < 16; r++)
+	{
+		uint32_t hits = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi16(counts[r], target));
+		if (hits != 0)
+		{
+			int lane = 0;
+			while (!((hits >> (2 * lane)) & 1))
+				lane++;
+			return r * 16 + lane;
+		}
+	}
+	return -1;
+#else
+	int best = -1;
+	int bestCount = 17;
+	for (int i = 0; i < 256; i++)
+	{
+		if (IsFixed(cells[i]))
+			continue;
+		int count = BitCount32(cells[i]);
+		if (count < bestCount)
+		{
+			best = i;
+			bestCount = count;
+			if (count <= 2)
+				break;
+		}
+	}
+	return best;
+#endif
+}
@@ -0,0 +1,72 @@
+#pragma once
+/*******************************************************************************
+ * GRID16 - Order-4 (16x16) board with one uint16_t candidate mask per cell
+ *
+ * With 16 values a cell fits in 16 bits, so a whole row, column or box is 16
+ * lanes of one 256-bit AVX2 register. The cells are kept row-major and, as a
+ * copy, column-major, so a row or a column is one load and a box is four
+ * 64-bit loads. On top of that the kernels are:
+ * - unit reductions: OR of a unit, and "seen once" / "seen twice" masks
+ *   (the values held by exactly one cell), as in-register horizontal folds
+ *   for one unit or as vertical folds over the 16 row vectors for all
+ *   columns (and all boxes of a band) at once
+ * - elimination: the fixed values of each cell's units, cleared from the
+ *   cell in one AND-NOT per row
+ * - candidate counting: a nibble-table popcount per lane, and the minimum
+ *   over the board with min/minpos
+ *
+ * SetCellAndPropagate() is the cascade of constraintpropagation.cpp (same
+ * rules, same visiting order, same counters) with vector peer reductions,
+ * for ant construction. Propagate() runs naked and hidden singles to a
+ * fixpoint over the whole board, for the backtracking search.
+ *
+ * The AVX2 kernels are compiled when __AVX2__ is defined (make AVX2=1);
+ * otherwise the same operations run as scalar loops.
+ ******************************************************************************/
+
+#include "board.h"
+#include <cstdint>
+
+class Grid16
+{
+	uint16_t cells[256];	// candidates, row-major (cell = row * 16 + column)
+	uint16_t cellsT[256];	// the same, column-major
+	int numFixed;		// counters as kept by Board
+	int numInfeasible;
+	int cpCalls;		// SetCellAndPropagate calls since FromBoard
+
+	void Set(int cell, uint16_t value)
+	{
+		cells[cell] = value;
+		cellsT[((cell & 15) << 4) | (cell >> 4)] = value;
+	}
+	void Transpose();
+	uint16_t PeerFixedValues(int cell) const;
+	void PeerValues(int cell, uint16_t& rowAll, uint16_t& colAll, uint16_t& boxAll) const;
+	void PropagateCell(int cell);
+
+public:
+	static bool Supports(int order) { return order == 4; }
+	static bool IsFixed(uint16_t x) { return x != 0 && (x & (x - 1)) == 0; }
+
+	// candidates and counters of board (order 4)
+	void FromBoard(const Board& board);
+	// out becomes puzzle with the candidates and counters of this grid
+	void ToBoard(const Board& puzzle, Board& out) const;
+
+	uint16_t Candidates(int cell) const { return cells[cell]; }
+	int FixedCellCount() const { return numFixed; }
+	int InfeasibleCellCount() const { return numInfeasible; }
+	int CPCalls() const { return cpCalls; }
+
+	// set cell and propagate to its peers (SetCellAndPropagate)
+	void SetCellAndPropagate(int cell, uint16_t value);
+
+	// set cell without propagation; Propagate() does the rest
+	void Place(int cell, uint16_t value) { Set(cell, value); }
+	// naked and hidden singles to a fixpoint; false on a contradiction
+	bool Propagate();
+	bool AllFixed() const { return numFixed == 256; }
+	// unfixed cell with the fewest candidates (the first one), -1 if all are fixed
+	int MostConstrainedCell() const;
+};
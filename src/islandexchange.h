@@ -0,0 +1,32 @@
+#pragma once
+/*******************************************************************************
+ * ISLAND EXCHANGE - Solution exchange of one alg 2 process with the others
+ *
+ * A ParallelSudokuAntSystem that runs as one island of a larger solve calls
+ * these at every communication (from the thread doing the exchange) and
+ * polls Solved() once per colony iteration, so none of them may block on the
+ * other islands. Implementations: IslandLink (islands.h, processes on one
+ * host over shared memory) and RemoteWorkerLink (remote.h, machines over
+ * TCP).
+ ******************************************************************************/
+
+#include "board.h"
+
+class IslandExchange
+{
+public:
+	virtual ~IslandExchange() {}
+
+	// offer this island's iteration-best (of its last sub-colony, which
+	// continues the ring) and its best best-so-far
+	virtual void Publish(const Board& iterationBest, const Board& bestSol) = 0;
+	// latest boards the topologies deliver to this island: iteration-best of
+	// the ring predecessor and best-so-far of a random other island; false if
+	// there is none yet. shape is any board of the puzzle's size.
+	virtual bool ReceiveIterationBest(const Board& shape, Board& out) = 0;
+	virtual bool ReceiveBestSol(const Board& shape, Board& out) = 0;
+
+	// this island has a complete solution / any island has one
+	virtual void MarkSolved() = 0;
+	virtual bool Solved() const = 0;
+};
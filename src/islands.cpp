@@ -0,0 +1,394 @@
+/*******************************************************************************
+ * ISLANDS - Implementation
+ ******************************************************************************/
+
+#include "islands.h"
+#include "parallelsudokuantsystem.h"
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#endif
+
+// Segment layout: header, one slot per island, one result area per island.
+// Slots and results are followed by their boards (one uint64_t per cell) and
+// padded to whole cache lines, so islands do not write to shared lines.
+struct IslandLink::Header
+{
+	std::atomic<int> solvedBy;	// island + 1 of the first complete solution, 0 = none
+};
+
+struct IslandLink::Slot
+{
+	std::atomic<uint32_t> seq;	// seqlock: odd while the island writes, 0 = never written
+	int32_t iterationBestFixed;
+	int32_t iterationBestInfeasible;
+	int32_t bestSolFixed;
+	int32_t bestSolInfeasible;
+	// followed by iterationBest[numCells], bestSol[numCells]
+};
+
+struct IslandLink::Result
+{
+	int32_t written;
+	int32_t success;
+	int32_t iterations;
+	int32_t communication;
+	int32_t fixed;
+	int32_t infeasible;
+	float time;
+	// followed by best[numCells]
+};
+
+static const size_t cacheLine = 64;
+
+static size_t RoundUp(size_t n)
+{
+	return (n + cacheLine - 1) / cacheLine * cacheLine;
+}
+
+IslandLink::Header *IslandLink::GetHeader() const
+{
+	return reinterpret_cast<Header*>(base);
+}
+
+IslandLink::Slot *IslandLink::GetSlot(int i) const
+{
+	return reinterpret_cast<Slot*>(base + RoundUp(sizeof(Header)) + i * slotStride);
+}
+
+IslandLink::Result *IslandLink::GetResult(int i) const
+{
+	return reinterpret_cast<Result*>(base + RoundUp(sizeof(Header)) + numIslands * slotStride + i * resultStride);
+}
+
+bool IslandLink::Create(int islands, int cells)
+{
+	Destroy();
+#ifdef _WIN32
+	(void)islands;
+	(void)cells;
+	return false;
+#else
+	numIslands = islands;
+	numCells = cells;
+	slotStride = RoundUp(sizeof(Slot) + 2 * cells * sizeof(uint64_t));
+	resultStride = RoundUp(sizeof(Result) + cells * sizeof(uint64_t));
+	size = RoundUp(sizeof(Header)) + islands * (slotStride + resultStride);
+
+	// the name is only needed until the mapping exists: the workers inherit it
+	std::string name = "/sudoku_ants_" + std::to_string((long)getpid());
+	int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (fd < 0)
+		return false;
+	shm_unlink(name.c_str());
+	void *mem = MAP_FAILED;
+	if (ftruncate(fd, (off_t)size) == 0)
+		mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mem == MAP_FAILED)
+		return false;
+	base = static_cast<unsigned char*>(mem);
+
+	// the segment is zero filled: construct the atomics in place
+	new (&GetHeader()->solvedBy) std::atomic<int>(0);
+	for (int i = 0; i < islands; i++)
+		new (&GetSlot(i)->seq) std::atomic<uint32_t>(0);
+	return true;
+#endif
+}
+
+void IslandLink::Destroy()
+{
+#ifndef _WIN32
+	if (base != nullptr)
+		munmap(base, size);
+#endif
+	base = nullptr;
+	size = 0;
+}
+
+void IslandLink::Encode(const Board& board, uint64_t *cells, int numCells)
+{
+	for (int i = 0; i < numCells; i++)
+		cells[i] = board.GetCell(i).GetBits();
+}
+
+void IslandLink::Decode(const uint64_t *cells, int fixed, int infeasible, const Board& puzzle, Board& out)
+{
+	out.Copy(puzzle);
+	int numUnits = puzzle.GetNumUnits();
+	for (int i = 0; i < puzzle.CellCount(); i++)
+		out.SetCellDirect(i, ValueSet(numUnits, cells[i]));
+	out.RestoreCounters(fixed, infeasible);
+}
+
+// ----------------------------------------------------------------------------
+// Publish: seqlock write of this island's slot (one writer per slot)
+// ----------------------------------------------------------------------------
+void IslandLink::Publish(const Board& iterationBest, const Board& bestSol)
+{
+	Slot *slot = GetSlot(island);
+	uint64_t *boards = reinterpret_cast<uint64_t*>(slot + 1);
+	uint32_t seq = slot->seq.load(std::memory_order_relaxed);
+	slot->seq.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot->iterationBestFixed = iterationBest.FixedCellCount();
+	slot->iterationBestInfeasible = iterationBest.InfeasibleCellCount();
+	slot->bestSolFixed = bestSol.FixedCellCount();
+	slot->bestSolInfeasible = bestSol.InfeasibleCellCount();
+	Encode(iterationBest, boards, numCells);
+	Encode(bestSol, boards + numCells, numCells);
+	slot->seq.store(seq + 2, std::memory_order_release);
+}
+
+// ----------------------------------------------------------------------------
+// Read: seqlock read of island from's slot, retried until the copy was not
+// overwritten during the read
+// ----------------------------------------------------------------------------
+bool IslandLink::Read(int from, bool bestSol, const Board& puzzle, Board& out) const
+{
+	const Slot *slot = GetSlot(from);
+	const uint64_t *board = reinterpret_cast<const uint64_t*>(slot + 1) + (bestSol ? numCells : 0);
+	uint64_t cells[64 * 64];	// largest board (order 8)
+	int fixed, infeasible;
+	uint32_t before, after;
+	do
+	{
+		before = slot->seq.load(std::memory_order_acquire);
+		if (before == 0)
+			return false;
+		if (before & 1)
+		{
+			std::this_thread::yield();
+			after = before + 1;
+			continue;
+		}
+		fixed = bestSol ? slot->bestSolFixed : slot->iterationBestFixed;
+		infeasible = bestSol ? slot->bestSolInfeasible : slot->iterationBestInfeasible;
+		memcpy(cells, board, numCells * sizeof(uint64_t));
+		std::atomic_thread_fence(std::memory_order_acquire);
+		after = slot->seq.load(std::memory_order_relaxed);
+	} while (before != after);
+	Decode(cells, fixed, infeasible, puzzle, out);
+	return true;
+}
+
+void IslandLink::SetIsland(int i)
+{
+	island = i;
+	partnerGen.seed((uint32_t)(std::random_device()() + i));
+}
+
+bool IslandLink::ReceiveIterationBest(const Board& shape, Board& out)
+{
+	return Read((island + numIslands - 1) % numIslands, false, shape, out);
+}
+
+bool IslandLink::ReceiveBestSol(const Board& shape, Board& out)
+{
+	std::uniform_int_distribution<int> otherIsland(1, numIslands - 1);
+	return Read((island + otherIsland(partnerGen)) % numIslands, true, shape, out);
+}
+
+void IslandLink::MarkSolved()
+{
+	int none = 0;
+	GetHeader()->solvedBy.compare_exchange_strong(none, island + 1);
+}
+
+bool IslandLink::Solved() const
+{
+	return GetHeader()->solvedBy.load(std::memory_order_relaxed) != 0;
+}
+
+void IslandLink::WriteResult(bool success, float time, int iterations, bool communication, const Board& best)
+{
+	Result *result = GetResult(island);
+	result->success = success;
+	result->time = time;
+	result->iterations = iterations;
+	result->communication = communication;
+	result->fixed = best.FixedCellCount();
+	result->infeasible = best.InfeasibleCellCount();
+	Encode(best, reinterpret_cast<uint64_t*>(result + 1), numCells);
+	result->written = 1;
+}
+
+bool IslandLink::ReadResult(int i, const Board& puzzle, Board& best, float& time, int& iterations, bool& communication) const
+{
+	const Result *result = GetResult(i);
+	if (!result->written)
+		return false;
+	Decode(reinterpret_cast<const uint64_t*>(result + 1), result->fixed, result->infeasible, puzzle, best);
+	time = result->time;
+	iterations = result->iterations;
+	communication = result->communication != 0;
+	return result->success != 0;
+}
+
+// ============================================================================
+// ISLAND SOLVER - Coordinator
+// ============================================================================
+
+IslandSolver::IslandSolver(int nIslands, int nColonies, bool pinIslands, Factory factory)
+	: numIslands(nIslands), numColonies(nColonies), pin(pinIslands), makeSolver(factory),
+	  solTime(0.0f), iterationsCompleted(0), communicationOccurred(false), winner(-1), ranIslands(false),
+	  stepMaxTime(0.0f), stepDone(false), stepSolved(false)
+{
+	if (numColonies < numIslands)
+		numColonies = numIslands;
+}
+
+// sub-colonies of island: an even share, the first islands take the remainder
+int IslandSolver::ColoniesOf(int island) const
+{
+	return numColonies / numIslands + (island < numColonies % numIslands ? 1 : 0);
+}
+
+// ----------------------------------------------------------------------------
+// RunIsland: Body of a worker process
+// ----------------------------------------------------------------------------
+void IslandSolver::RunIsland(IslandLink& link, int island, const Board& puzzle, float maxTime)
+{
+	link.SetIsland(island);
+#ifdef __linux__
+	if (pin)
+	{
+		// contiguous CPU blocks, which on most machines follow the sockets
+		int cpus = (int)std::thread::hardware_concurrency();
+		int perIsland = cpus / numIslands;
+		if (perIsland > 0)
+		{
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			for (int c = island * perIsland; c < (island + 1) * perIsland; c++)
+				CPU_SET(c, &set);
+			sched_setaffinity(0, sizeof(set), &set);
+		}
+	}
+#endif
+	ParallelSudokuAntSystem *solver = makeSolver(island, ColoniesOf(island));
+	solver->SetIsland(&link);
+	bool success = solver->Solve(puzzle, maxTime);
+	link.WriteResult(success, solver->GetSolutionTime(), solver->GetIterationsCompleted(),
+		solver->GetCommunicationOccurred(), solver->GetSolution());
+	delete solver;
+}
+
+// all colonies in one ParallelSudokuAntSystem, in this process
+bool IslandSolver::SolveInProcess(const Board& puzzle, float maxTime)
+{
+	ParallelSudokuAntSystem *solver = makeSolver(0, numColonies);
+	bool success = solver->Solve(puzzle, maxTime);
+	solution.Copy(solver->GetSolution());
+	solTime = solver->GetSolutionTime();
+	iterationsCompleted = solver->GetIterationsCompleted();
+	communicationOccurred = solver->GetCommunicationOccurred();
+	winner = success ? 0 : -1;
+	ranIslands = false;
+	delete solver;
+	return success;
+}
+
+// ----------------------------------------------------------------------------
+// Solve: fork one worker per island, wait for all of them, then take the
+// fastest complete solution, or else the best partial one
+// ----------------------------------------------------------------------------
+bool IslandSolver::Solve(const Board& puzzle, float maxTime)
+{
+	IslandLink link;
+	if (numIslands <= 1 || !link.Create(numIslands, puzzle.CellCount()))
+		return SolveInProcess(puzzle, maxTime);
+#ifdef _WIN32
+	return SolveInProcess(puzzle, maxTime);
+#else
+	std::vector<pid_t> workers;
+	for (int i = 0; i < numIslands; i++)
+	{
+		pid_t pid = fork();
+		if (pid == 0)
+		{
+			RunIsland(link, i, puzzle, maxTime);
+			_exit(0);	// no atexit handlers or stdio flushes of the coordinator
+		}
+		if (pid > 0)
+			workers.push_back(pid);
+	}
+	if (workers.empty())
+		return SolveInProcess(puzzle, maxTime);
+	for (pid_t pid : workers)
+	{
+		int status;
+		waitpid(pid, &status, 0);
+	}
+
+	ranIslands = true;
+	winner = -1;
+	solution.Copy(puzzle);
+	solTime = 0.0f;
+	iterationsCompleted = 0;
+	communicationOccurred = false;
+	Board best;
+	for (int i = 0; i < numIslands; i++)
+	{
+		float time = 0.0f;
+		int iterations = 0;
+		bool communication = false;
+		bool success = link.ReadResult(i, puzzle, best, time, iterations, communication);
+		communicationOccurred = communicationOccurred || communication;
+		if (iterations > iterationsCompleted)
+			iterationsCompleted = iterations;
+		if (success && (winner < 0 || time < solTime))
+		{
+			winner = i;
+			solution.Copy(best);
+			solTime = time;
+		}
+		else if (winner < 0 && best.FixedCellCount() > solution.FixedCellCount())
+			solution.Copy(best);
+		if (winner < 0 && time > solTime)
+			solTime = time;
+	}
+	return winner >= 0;
+#endif
+}
+
+void IslandSolver::Start(const Board& puzzle, float maxTime)
+{
+	stepPuzzle.Copy(puzzle);
+	stepMaxTime = maxTime;
+	stepDone = false;
+	stepSolved = false;
+}
+
+SolveProgress IslandSolver::Step(int budget)
+{
+	SolveProgress progress;
+	progress.steps = 0;
+	if (!stepDone && budget > 0)
+	{
+		stepSolved = Solve(stepPuzzle, stepMaxTime);
+		stepDone = true;
+		progress.steps = 1;
+	}
+	progress.state = !stepDone ? SOLVE_RUNNING : (stepSolved ? SOLVE_SOLVED : SOLVE_FAILED);
+	progress.totalSteps = stepDone ? 1 : 0;
+	progress.bestScore = solution.FixedCellCount();
+	progress.elapsed = solTime;
+	return progress;
+}
+
+bool IslandSolver::Finish()
+{
+	return stepSolved;
+}
@@ -0,0 +1,132 @@
+#pragma once
+/*******************************************************************************
+ * ISLANDS - Algorithm 2 over several processes on one host (--islands n)
+ *
+ * One alg 2 process with many threads shares one heap and, on multi-socket
+ * machines, pulls boards and pheromone rows across sockets. In island mode a
+ * coordinator process forks n workers (islands), each running its own
+ * ParallelSudokuAntSystem on a share of the sub-colonies, optionally pinned
+ * to its own block of CPUs.
+ *
+ * The islands exchange boards through a POSIX shared memory segment that the
+ * coordinator maps before forking. Every island owns one slot with its latest
+ * iteration-best and best-so-far, guarded by a seqlock: the island's master
+ * thread is the only writer and makes the sequence odd while it writes, so
+ * readers in other processes copy the boards without locks and retry if the
+ * sequence changed under them. The slots form a ring: at each communication
+ * an island publishes its slot and reads the slot of the previous island
+ * (iteration-best, extending the ring topology across the processes) and of
+ * a random other island (best-so-far, the random topology). Islands do not
+ * wait for each other, so a read may return the boards of an earlier
+ * exchange; a repeated board is discarded by the receiving colony.
+ *
+ * The first island with a complete solution raises a shared flag that stops
+ * the others. Each worker writes its result to its own result area before it
+ * exits, and the coordinator collects them after waiting for all workers.
+ * Without POSIX shared memory (or if the segment cannot be created) the
+ * solve runs as a single island in the calling process.
+ ******************************************************************************/
+
+#include "board.h"
+#include "sudokusolver.h"
+#include "islandexchange.h"
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+class ParallelSudokuAntSystem;
+
+// The shared memory segment of an island run, as seen from one process
+class IslandLink : public IslandExchange
+{
+	unsigned char *base;	// mapping (nullptr = none)
+	size_t size;
+	size_t slotStride;
+	size_t resultStride;
+	int numIslands;
+	int numCells;
+	int island;				// island of this process
+	std::mt19937 partnerGen;	// random topology partners
+
+	struct Header;
+	struct Slot;
+	struct Result;
+	Header *GetHeader() const;
+	Slot *GetSlot(int i) const;
+	Result *GetResult(int i) const;
+	static void Encode(const Board& board, uint64_t *cells, int numCells);
+	static void Decode(const uint64_t *cells, int fixed, int infeasible, const Board& puzzle, Board& out);
+	bool Read(int from, bool bestSol, const Board& puzzle, Board& out) const;
+
+public:
+	IslandLink() : base(nullptr), size(0), slotStride(0), resultStride(0), numIslands(0), numCells(0), island(0) {}
+	~IslandLink() { Destroy(); }
+
+	// coordinator: map a new segment for numIslands islands (false if unavailable)
+	bool Create(int numIslands, int numCells);
+	void Destroy();
+	// worker: the island of this process (after the fork)
+	void SetIsland(int i);
+	int Island() const { return island; }
+	int NumIslands() const { return numIslands; }
+
+	// solution exchange: publish this island's slot; receive reads the slot
+	// of the previous island (ring) or of a random other island (false if
+	// that island has published nothing yet)
+	virtual void Publish(const Board& iterationBest, const Board& bestSol);
+	virtual bool ReceiveIterationBest(const Board& shape, Board& out);
+	virtual bool ReceiveBestSol(const Board& shape, Board& out);
+
+	// any island has a complete solution
+	virtual void MarkSolved();
+	virtual bool Solved() const;
+
+	// result of an island: written by its worker before exiting, read by the
+	// coordinator after all workers have exited
+	void WriteResult(bool success, float time, int iterations, bool communication, const Board& best);
+	bool ReadResult(int i, const Board& puzzle, Board& best, float& time, int& iterations, bool& communication) const;
+};
+
+// Alg 2 solver that runs its sub-colonies as islands in worker processes
+class IslandSolver : public SudokuSolver
+{
+public:
+	// configured solver for one island with numColonies sub-colonies
+	typedef std::function<ParallelSudokuAntSystem*(int island, int numColonies)> Factory;
+
+private:
+	int numIslands;
+	int numColonies;		// over all islands
+	bool pin;				// pin each island to its block of CPUs
+	Factory makeSolver;
+	Board solution;
+	float solTime;
+	int iterationsCompleted;
+	bool communicationOccurred;
+	int winner;				// island that found the solution (-1 = none)
+	bool ranIslands;		// false if the last solve ran in-process
+	Board stepPuzzle;
+	float stepMaxTime;
+	bool stepDone;
+	bool stepSolved;
+
+	int ColoniesOf(int island) const;
+	void RunIsland(IslandLink& link, int island, const Board& puzzle, float maxTime);
+	bool SolveInProcess(const Board& puzzle, float maxTime);
+
+public:
+	IslandSolver(int numIslands, int numColonies, bool pin, Factory makeSolver);
+
+	virtual bool Solve(const Board& puzzle, float maxTime);
+	// resumable interface; the whole island solve is one work unit
+	virtual void Start(const Board& puzzle, float maxTime);
+	virtual SolveProgress Step(int budget);
+	virtual bool Finish();
+	virtual float GetSolutionTime() { return solTime; }
+	virtual const Board& GetSolution() { return solution; }
+	int GetIterationsCompleted() const { return iterationsCompleted; }
+	bool GetCommunicationOccurred() const { return communicationOccurred; }
+	int GetWinner() const { return winner; }
+	bool RanIslands() const { return ranIslands; }
+};
@@ -0,0 +1,202 @@
+/*******************************************************************************
+ * PARALLEL PROPAGATION - Implementation
+ ******************************************************************************/
+
+#include "parallelpropagation.h"
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+static const int minParallelOrder = 6;
+static int g_initialCPThreads = 0;
+
+void SetInitialCPThreads(int n)
+{
+	g_initialCPThreads = n;
+}
+
+int InitialCPThreads(int order)
+{
+	if (order < minParallelOrder)
+		return 1;
+	int threads = (g_initialCPThreads > 0) ? g_initialCPThreads : (int)std::thread::hardware_concurrency();
+	return (threads > 1) ? threads : 1;
+}
+
+namespace
+{
+	// candidates a unit leaves an open cell
+	struct Change
+	{
+		int cell;
+		uint64_t keep;
+	};
+}
+
+bool PropagateInitialParallel(Board& board, const std::vector<int>& givens, int numThreads)
+{
+	int numUnits = board.GetNumUnits();
+	int numCells = board.CellCount();
+	int numUnitsAll = 3 * numUnits;
+	if (numThreads > numUnitsAll)
+		numThreads = numUnitsAll;
+	uint64_t full = (~ValueSet(numUnits)).GetBits();
+
+	// cells of every unit: rows, then columns, then boxes
+	std::vector<int> unitCells(numUnitsAll * numUnits);
+	for (int u = 0; u < numUnits; u++)
+	{
+		for (int j = 0; j < numUnits; j++)
+		{
+			unitCells[u * numUnits + j] = board.RowCell(u, j);
+			unitCells[(numUnits + u) * numUnits + j] = board.ColCell(u, j);
+			unitCells[(2 * numUnits + u) * numUnits + j] = board.BoxCell(u, j);
+		}
+	}
+
+	for (int i = 0; i < numCells; i++)
+	{
+		if (givens[i] > 0)
+		{
+			board.SetCellDirect(i, ValueSet(numUnits, (uint64_t)1 << (givens[i] - 1)));
+			board.IncrementFixedCells();
+		}
+	}
+
+	std::vector<std::vector<Change>> changes(numThreads);
+	std::atomic<bool> contradiction(false);
+
+	// thread t scans units t, t + numThreads, ... (the board is read-only here)
+	auto scanUnits = [&](int t)
+	{
+		std::vector<Change>& found = changes[t];
+		found.clear();
+		for (int u = t; u < numUnitsAll && !contradiction; u += numThreads)
+		{
+			const int *cells = &unitCells[u * numUnits];
+			uint64_t fixedValues = 0, once = 0, twice = 0;
+			for (int j = 0; j < numUnits; j++)
+			{
+				const ValueSet& cell = board.GetCell(cells[j]);
+				uint64_t bits = cell.GetBits();
+				if (cell.Fixed())
+				{
+					if (fixedValues & bits)
+						contradiction = true;
+					fixedValues |= bits;
+				}
+				twice |= once & bits;
+				once |= bits;
+			}
+			if (once != full)
+				contradiction = true;
+			uint64_t hidden = once & ~twice;	// values with one place in the unit
+
+			for (int j = 0; j < numUnits; j++)
+			{
+				const ValueSet& cell = board.GetCell(cells[j]);
+				if (cell.Fixed())
+					continue;
+				uint64_t bits = cell.GetBits();
+				uint64_t keep = full & ~fixedValues;
+				uint64_t single = bits & hidden;
+				if (single != 0)
+				{
+					if (!ValueSet(numUnits, single).Fixed())
+						contradiction = true;
+					keep &= single;
+				}
+				if ((bits & keep) != bits)
+					found.push_back({ cells[j], keep });
+			}
+		}
+	};
+
+	// the workers (threads 1 and up) are started once; the calling thread,
+	// which scans as thread 0, hands them one round after another
+	std::mutex roundMutex;
+	std::condition_variable roundStart, roundEnd;
+	int round = 0;
+	int running = 0;
+	bool finished = false;
+	auto worker = [&](int t)
+	{
+		int done = 0;
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(roundMutex);
+				roundStart.wait(lock, [&]() { return finished || round != done; });
+				if (finished)
+					return;
+				done = round;
+			}
+			scanUnits(t);
+			std::lock_guard<std::mutex> lock(roundMutex);
+			if (--running == 0)
+				roundEnd.notify_one();
+		}
+	};
+	std::vector<std::thread> workers;
+	for (int t = 1; t < numThreads; t++)
+		workers.emplace_back(worker, t);
+
+	bool propagated = false;
+	for (;;)
+	{
+		{
+			std::lock_guard<std::mutex> lock(roundMutex);
+			round++;
+			running = numThreads - 1;
+		}
+		roundStart.notify_all();
+		scanUnits(0);
+		{
+			std::unique_lock<std::mutex> lock(roundMutex);
+			roundEnd.wait(lock, [&]() { return running == 0; });
+		}
+		if (contradiction)
+			break;
+
+		// merge: every cell keeps what all its units leave it
+		bool changed = false;
+		bool empty = false;
+		for (int t = 0; t < numThreads && !empty; t++)
+		{
+			for (const Change& change : changes[t])
+			{
+				uint64_t bits = board.GetCell(change.cell).GetBits();
+				uint64_t kept = bits & change.keep;
+				if (kept == bits)
+					continue;
+				if (kept == 0)
+				{
+					empty = true;
+					break;
+				}
+				ValueSet value(numUnits, kept);
+				board.SetCellDirect(change.cell, value);
+				if (value.Fixed())
+					board.IncrementFixedCells();
+				changed = true;
+			}
+		}
+		if (empty)
+			break;
+		if (!changed)
+		{
+			propagated = true;
+			break;
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(roundMutex);
+		finished = true;
+	}
+	roundStart.notify_all();
+	for (auto& w : workers)
+		w.join();
+	return propagated;
+}
@@ -0,0 +1,39 @@
+#pragma once
+/*******************************************************************************
+ * PARALLEL PROPAGATION - Initial constraint propagation on several threads
+ *
+ * On 49x49 and 64x64 boards the serial propagation of the givens takes a
+ * noticeable share of the run before any solver starts. The parallel path
+ * places all givens first and then works in rounds:
+ * - the 3 * numUnits units (rows, columns, boxes) are split over the
+ *   threads; each thread scans its units against the board as it was at the
+ *   start of the round and records, per open cell, the candidates that
+ *   rule 1 (values fixed in the unit) and rule 2 (a value with no other
+ *   place in the unit) leave, in its own change list
+ * - the change lists are then merged into the board (a cell keeps the
+ *   intersection of everything recorded for it)
+ * The rounds repeat until one changes nothing, which is the fixpoint of both
+ * rules. The threads are started once and handed one round after another.
+ * The Board constructor takes this path only with SetInitialCPFixpoint(true),
+ * where the serial path ends at the same fixpoint (PropagateToFixpoint); for
+ * a puzzle with a solution that fixpoint does not depend on the order the
+ * rules were applied in, so both paths produce the same board.
+ * If a round finds a contradiction (an empty cell, a value fixed twice or
+ * with no place in a unit, or two hidden singles in one cell) the parallel
+ * path gives up and the board is built by the serial path instead.
+ ******************************************************************************/
+
+#include "board.h"
+#include <vector>
+
+// threads for the initial propagation of boards of order 6 and up (0 = one
+// per hardware thread, 1 = always serial)
+void SetInitialCPThreads(int n);
+// threads to use for a board of this order (1 = serial path)
+int InitialCPThreads(int order);
+
+// Propagate the givens (value index + 1 of each cell, 0 = open) of a board
+// whose cells are all open, to the fixpoint of rules 1 and 2, on numThreads
+// threads. Returns false on a contradiction, leaving the board partly
+// propagated (it must then be rebuilt by the serial path).
+bool PropagateInitialParallel(Board& board, const std::vector<int>& givens, int numThreads);
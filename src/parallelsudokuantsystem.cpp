@@ -12,9 +12,22 @@
  * - Three-source pheromone update (local + 2 received solutions)
  * - Timeout-based termination (default 120 seconds)
  * - Immediate stop upon finding complete solution
+ * - Optional exact finisher shared by all colonies
+ * - Optional elite archive per colony: diverse good solutions feed the
+ *   communication update and are reinjected on stagnation
+ * - Optional stagnation detection per colony: partial or full pheromone
+ *   restart when a colony stops improving
+ * - Worker pool for more colonies than cores: colony iterations are tasks
+ *   and communication rounds are phase boundaries instead of barriers
+ * - Resumable single-threaded mode (Start/Step/Finish) that runs the
+ *   colonies round-robin with the same communication schedule
+ * - Deterministic mode (SetSeed): seeds derived from one master seed and
+ *   stops only at sync points, so the threaded and the round-robin solve
+ *   give the same result on any number of cores
  ******************************************************************************/
 
 #include "parallelsudokuantsystem.h"
+#include "islandexchange.h"
 #include <iostream>
 #include <algorithm>
 #include <numeric>
@@ -24,14 +37,25 @@
 // SUBCOLONY CLASS - Represents one independent ant colony in a thread
 // ============================================================================
 
+// Same fixed cells (Zobrist hash and count), without a cell-by-cell scan
+static bool SameFixedCells(const Board& a, const Board& b)
+{
+	return a.Hash() == b.Hash() && a.FixedCellCount() == b.FixedCellCount();
+}
+
 // ----------------------------------------------------------------------------
 // Constructor: Initialize a sub-colony with its own parameters
 // ----------------------------------------------------------------------------
 SubColony::SubColony(int id, int numAnts, float q0, float rho, float pher0, float bestEvap)
-	: numAnts(numAnts), q0(q0), rho(rho), pher0(pher0), bestEvap(bestEvap), bestPher(0.0f),
+	: numAnts(numAnts), q0(q0), rho(rho), pher0(pher0),
 	  iterationBestScore(0), bestSolScore(0), receivedIterationBestScore(0), receivedBestSolScore(0),
-	  currentIteration(0), pher(nullptr), numCells(0), numUnits(0),
-	  contributions(nullptr), hasContribution(nullptr)
+	  pher(nullptr), pherCells(0), pherUnits(0), numCells(0), numUnits(0),
+	  contributions(nullptr), hasContribution(nullptr), variant(VARIANT_ACS), prior(PRIOR_NONE), antOrdering(ORDER_SEQUENTIAL),
+	  antEngine(ANT_ENGINE_SCALAR), population(this),
+	  antBacktrackDepth(0), antBacktrackBudget(0), antProbeCandidates(0),
+	  eliteSize(0), eliteDistance(5.0f), eliteStagnation(500), bestFoundScore(0), lastImprovement(0),
+	  runIteration(nullptr), updatePheromone(nullptr), updatePheromoneWithCommunication(nullptr),
+	  currentIteration(0), bestPher(0.0f), bestEvap(bestEvap)
 {
 	// Initialize random number generator with unique seed per colony
 	randomDist = std::uniform_real_distribution<float>(0.0f, 1.0f);
@@ -39,6 +63,13 @@ SubColony::SubColony(int id, int numAnts, float q0, float rho, float pher0, floa
 	randGen = std::mt19937(rd() + id); // Different seed ensures diversity
 }
 
+void SubColony::Seed(uint64_t seed)
+{
+	randGen.seed((uint32_t)(seed ^ (seed >> 32)));
+	randomDist.reset();
+	startPosDist.reset();
+}
+
 SubColony::~SubColony()
 {
 	for (auto a : antList)
@@ -51,39 +82,90 @@ SubColony::~SubColony()
 		delete[] hasContribution;
 }
 
+// ----------------------------------------------------------------------------
+// Reset: Size the colony's buffers for puzzles of the given order
+// The ants, the pheromone matrix and the update arrays are created once and
+// only grow, so later puzzles of the same or a smaller order allocate nothing
+// ----------------------------------------------------------------------------
+void SubColony::Reset(int order)
+{
+	int units = order * order;
+	int cells = units * units;
+	
+	// === ANT POPULATION SETUP ===
+	if (antList.empty())
+	{
+		for (int i = 0; i < numAnts; i++)
+			antList.push_back(new SudokuAnt(this, antOrdering));
+	}
+	for (auto a : antList)
+	{
+		a->SetBacktracking(antBacktrackDepth, antBacktrackBudget);
+		a->SetProbing(antProbeCandidates);
+		a->SetHeatmap(&heatmap);
+		a->Reset(units);
+	}
+	if (antEngine != ANT_ENGINE_SCALAR)
+	{
+		population.Reset(numAnts, order, antEngine);
+		if ((int)startCells.size() < numAnts)
+			startCells.resize(numAnts);
+	}
+	
+	// === PHEROMONE MATRIX ===
+	if (cells > pherCells || units > pherUnits)
+	{
+		if (pher != nullptr)
+			ClearPheromone();
+		pher = new float*[cells];
+		for (int i = 0; i < cells; i++)
+			pher[i] = new float[units];
+		pherCells = cells;
+		pherUnits = units;
+		
+		// Temporary arrays for pheromone updates (performance optimization)
+		// These arrays are reused every iteration to avoid repeated allocations
+		if (contributions != nullptr)
+			delete[] contributions;
+		if (hasContribution != nullptr)
+			delete[] hasContribution;
+		contributions = new float[units];
+		hasContribution = new bool[units];
+	}
+}
+
 // ----------------------------------------------------------------------------
 // Initialize: Prepare sub-colony for a new puzzle
 // Called once before starting the parallel algorithm
 // ----------------------------------------------------------------------------
 void SubColony::Initialize(const Board& puzzle)
 {
+	Reset(puzzle.GetOrder());
 	numCells = puzzle.CellCount();
 	numUnits = puzzle.GetNumUnits();
 	
 	// Setup random distribution for ant starting positions
 	startPosDist = std::uniform_int_distribution<int>(0, numCells - 1);
-	
-	// === ANT POPULATION SETUP ===
-	// Clear old ants if any
-	for (auto a : antList)
-		delete a;
-	antList.clear();
-	
-	// Create new ant population
-	for (int i = 0; i < numAnts; i++)
-		antList.push_back(new SudokuAnt(this));
+	heatmap.Reset(numCells);
+	antCount.Reset(numAnts, puzzle.FixedCellCount());
 	
 	// === PHEROMONE MATRIX INITIALIZATION ===
 	InitPheromone(numCells, numUnits);
-	
-	// Allocate temporary arrays for pheromone updates (performance optimization)
-	// These arrays are reused every iteration to avoid repeated allocations
-	if (contributions != nullptr)
-		delete[] contributions;
-	if (hasContribution != nullptr)
-		delete[] hasContribution;
-	contributions = new float[numUnits];
-	hasContribution = new bool[numUnits];
+	ApplyPheromonePrior(pher, puzzle, pher0, prior);
+	// the update rules are fixed for the whole solve
+	switch (variant)
+	{
+	case VARIANT_MMAS:
+		SelectPolicy<MMASPolicy>();
+		break;
+	case VARIANT_ITERATION_BEST:
+		SelectPolicy<IterationBestPolicy>();
+		break;
+	case VARIANT_ACS:
+	default:
+		SelectPolicy<ACSPolicy>();
+		break;
+	}
 	
 	// === SOLUTION TRACKING INITIALIZATION ===
 	iterationBest.Copy(puzzle);
@@ -97,18 +179,29 @@ void SubColony::Initialize(const Board& puzzle)
 	receivedBestSolScore = 0;
 	currentIteration = 0;
 	bestPher = 0.0f;  // Reset best pheromone value
+	
+	// === ELITE ARCHIVE ===
+	elites.Configure(eliteSize, std::max(1, (int)(eliteDistance * numCells / 100.0f)));
+	elites.Reset(puzzle);
+	bestFoundScore = puzzle.FixedCellCount();
+	lastImprovement = 0;
+	stagnation.Reset(puzzle.FixedCellCount());
+}
+
+// Point the per-iteration entry points at the instantiations of Policy
+template<class Policy>
+void SubColony::SelectPolicy()
+{
+	runIteration = &SubColony::RunIterationT<Policy>;
+	updatePheromone = &SubColony::UpdatePheromoneT<Policy>;
+	updatePheromoneWithCommunication = &SubColony::UpdatePheromoneWithCommunicationT<Policy>;
 }
 
 void SubColony::InitPheromone(int numCells, int valuesPerCell)
 {
-	if (pher != nullptr)
-		ClearPheromone();
-	
 	this->numCells = numCells;
-	pher = new float*[numCells];
 	for (int i = 0; i < numCells; i++)
 	{
-		pher[i] = new float[valuesPerCell];
 		for (int j = 0; j < valuesPerCell; j++)
 			pher[i][j] = pher0;
 	}
@@ -116,15 +209,17 @@ void SubColony::InitPheromone(int numCells, int valuesPerCell)
 
 void SubColony::ClearPheromone()
 {
-	for (int i = 0; i < numCells; i++)
+	for (int i = 0; i < pherCells; i++)
 		delete[] pher[i];
 	delete[] pher;
 	pher = nullptr;
+	pherCells = 0;
+	pherUnits = 0;
 }
 
 float SubColony::PherAdd(int numCellsFixed)
 {
-	return numCells / (float)(numCells - numCellsFixed);
+	return ACSPolicy::Deposit(numCells, numCellsFixed);
 }
 
 // ============================================================================
@@ -135,16 +230,23 @@ float SubColony::PherAdd(int numCellsFixed)
 //
 // EQUATION: τ_ij(t+1) = (1-ρ)·τ_ij(t) + ρ·Δτ_best
 //           where ρ = 0.9 (standard ACS parameter)
+//
+// Other variants (MMAS bounds, iteration-best deposit) use a different
+// policy instantiation, selected by Initialize (see pheromonepolicy.h).
 // ============================================================================
-void SubColony::UpdatePheromone()
+template<class Policy>
+void SubColony::UpdatePheromoneT()
 {
-	for (int i = 0; i < numCells; i++)
-	{
-		if (bestSol.GetCell(i).Fixed())
-		{
-			pher[i][bestSol.GetCell(i).Index()] = pher[i][bestSol.GetCell(i).Index()] * (1.0f - rho) + rho * bestPher;
-		}
-	}
+	if (Policy::useIterationBest)
+		GlobalPheromoneUpdate<Policy>(pher, numCells, numUnits, iterationBest, rho, PherAdd(iterationBestScore));
+	else
+		GlobalPheromoneUpdate<Policy>(pher, numCells, numUnits, bestSol, rho, bestPher);
+}
+
+void SubColony::EvaporateBestPher()
+{
+	// all current variants share the ACS decay of the best pheromone value
+	ACSPolicy::EvaporateBest(bestPher, bestEvap);
 }
 
 // ============================================================================
@@ -160,16 +262,40 @@ void SubColony::UpdatePheromone()
 // SOURCE 1 (Δτ_ij^1): Local iteration-best (this colony's best this iteration)
 // SOURCE 2 (Δτ_ij^2): Received iteration-best (from ring topology neighbor)
 // SOURCE 3 (Δτ_ij^3): Received best-so-far (from random topology partner)
+// SOURCE 4 (optional): A random elite of the colony's archive
+// Sources with the same fixed cells as an earlier one are skipped
 //
 // SELECTIVE EVAPORATION: Only applies evaporation to [cell,digit] pairs that
 //                        receive pheromone deposits (not all cells)
 // ============================================================================
-void SubColony::UpdatePheromoneWithCommunication()
+template<class Policy>
+void SubColony::UpdatePheromoneWithCommunicationT()
 {
 	// --- STEP 1: Calculate pheromone deposit amounts for each source ---
+	// A source identical to an earlier one (same fixed cells, compared by
+	// Zobrist hash) is skipped, so a shared solution is not deposited twice
+	bool use2 = receivedIterationBestScore > 0 && !SameFixedCells(receivedIterationBest, iterationBest);
+	bool use3 = receivedBestSolScore > 0 && !SameFixedCells(receivedBestSol, iterationBest)
+	            && !(use2 && SameFixedCells(receivedBestSol, receivedIterationBest));
+	// Source 4 (with an elite archive): a random elite of this colony
+	const Board *elite = nullptr;
+	int eliteScore = 0;
+	if (elites.Size() > 0)
+	{
+		int k = std::uniform_int_distribution<int>(0, elites.Size() - 1)(randGen);
+		const Board &e = elites.Get(k);
+		if (!SameFixedCells(e, iterationBest) && !(use2 && SameFixedCells(e, receivedIterationBest))
+		    && !(use3 && SameFixedCells(e, receivedBestSol)))
+		{
+			elite = &e;
+			eliteScore = elites.Score(k);
+		}
+	}
 	float pherValue1 = (iterationBestScore > 0) ? PherAdd(iterationBestScore) : 0.0f;
-	float pherValue2 = (receivedIterationBestScore > 0) ? PherAdd(receivedIterationBestScore) : 0.0f;
-	float pherValue3 = (receivedBestSolScore > 0) ? PherAdd(receivedBestSolScore) : 0.0f;
+	float pherValue2 = use2 ? PherAdd(receivedIterationBestScore) : 0.0f;
+	float pherValue3 = use3 ? PherAdd(receivedBestSolScore) : 0.0f;
+	float pherValue4 = (elite != nullptr) ? PherAdd(eliteScore) : 0.0f;
+	float tauMax = std::max(std::max(pherValue1, pherValue4), std::max(pherValue2, pherValue3));
 	
 	// --- STEP 2: Process each cell ---
 	for (int i = 0; i < numCells; i++)
@@ -189,7 +315,7 @@ void SubColony::UpdatePheromoneWithCommunication()
 		}
 		
 		// Source 2: Iteration-best from ring topology neighbor
-		if (receivedIterationBestScore > 0 && receivedIterationBest.GetCell(i).Fixed())
+		if (use2 && receivedIterationBest.GetCell(i).Fixed())
 		{
 			int digit = receivedIterationBest.GetCell(i).Index();
 			contributions[digit] += pherValue2;
@@ -197,71 +323,114 @@ void SubColony::UpdatePheromoneWithCommunication()
 		}
 		
 		// Source 3: Best-so-far from random topology partner
-		if (receivedBestSolScore > 0 && receivedBestSol.GetCell(i).Fixed())
+		if (use3 && receivedBestSol.GetCell(i).Fixed())
 		{
 			int digit = receivedBestSol.GetCell(i).Index();
 			contributions[digit] += pherValue3;
 			hasContribution[digit] = true;
 		}
 		
+		// Source 4: Elite from this colony's archive
+		if (elite != nullptr && elite->GetCell(i).Fixed())
+		{
+			int digit = elite->GetCell(i).Index();
+			contributions[digit] += pherValue4;
+			hasContribution[digit] = true;
+		}
+		
 		// --- STEP 4: Apply evaporation + reinforcement ---
-		// Only for [cell, digit] pairs that received contributions
+		// ACS: only for [cell, digit] pairs that received contributions
+		// MMAS: every entry evaporates, then bounded by the largest deposit
 		for (int j = 0; j < numUnits; j++)
 		{
+			Policy::Evaporate(pher[i][j], rho);
 			if (hasContribution[j])
 			{
 				// Evaporate old pheromone, add new contribution
 				// Using rho for communication update
-				pher[i][j] = pher[i][j] * (1.0f - rho) + rho * contributions[j];
+				Policy::Reinforce(pher[i][j], rho, contributions[j]);
 			}
+			if (Policy::evaporateAll)
+				Policy::Bound(pher[i][j], tauMax / (2.0f * numUnits), tauMax);
 		}
 	}
 }
 
-void SubColony::LocalPheromoneUpdate(int iCell, int iChoice)
-{
-	pher[iCell][iChoice] = pher[iCell][iChoice] * 0.9f + pher0 * 0.1f;
-}
-
 // ----------------------------------------------------------------------------
-// RunIteration: Execute one complete iteration of the ant colony
+// RunIteration: Execute one complete iteration of the ant colony (Policy
+// supplies the ants' local pheromone update)
 // ----------------------------------------------------------------------------
-void SubColony::RunIteration(const Board& puzzle)
+template<class Policy>
+void SubColony::RunIterationT(const Board& puzzle)
 {
 	// === PHASE 1: SOLUTION CONSTRUCTION ===
-	// Start each ant on a random cell (for diversity)
-	for (auto a : antList)
-	{
-		a->InitSolution(puzzle, startPosDist(randGen));
-	}
-	
-	// Each ant constructs a solution by visiting all cells
-	for (int i = 0; i < numCells; i++)
+	// Only the first antCount.Active() ants run
+	int active = antCount.Active();
+	iterationTimer.Reset();
+	if (antEngine != ANT_ENGINE_SCALAR)
 	{
-		// All ants take one step (fill one cell)
-		for (auto a : antList)
+		// same start cell draws as below, then all ants in one population
+		for (int i = 0; i < active; i++)
+			startCells[i] = heatmap.DrawStartCell(randGen, startPosDist, randomDist);
+		population.SetActive(active);
+		population.Construct<Policy>(puzzle, startCells.data());
+		
+		int iBest = 0;
+		int bestVal = 0;
+		for (int i = 0; i < active; i++)
 		{
-			a->StepSolution();
+			if (population.NumCellsFilled(i) > bestVal)
+			{
+				bestVal = population.NumCellsFilled(i);
+				iBest = i;
+			}
 		}
+		population.ExportSolution(iBest, puzzle, iterationBest);
+		iterationBestScore = bestVal;
 	}
-	
-	// === PHASE 2: SOLUTION EVALUATION ===
-	// Find the best ant in this iteration
-	int iBest = 0;
-	int bestVal = 0;
-	for (unsigned int i = 0; i < antList.size(); i++)
+	else
 	{
-		if (antList[i]->NumCellsFilled() > bestVal)
+		// Start each ant on a random cell (for diversity; drawn from the heatmap, if biased)
+		for (int i = 0; i < active; i++)
 		{
-			bestVal = antList[i]->NumCellsFilled();
-			iBest = i;
+			antList[i]->InitSolution(puzzle, heatmap.DrawStartCell(randGen, startPosDist, randomDist));
 		}
+		
+		// Each ant constructs a solution by visiting all cells
+		for (int i = 0; i < numCells; i++)
+		{
+			// All ants take one step (fill one cell)
+			for (int j = 0; j < active; j++)
+			{
+				antList[j]->StepSolution<Policy>();
+			}
+		}
+		
+		// === PHASE 2: SOLUTION EVALUATION ===
+		// Find the best ant in this iteration
+		int iBest = 0;
+		int bestVal = 0;
+		for (int i = 0; i < active; i++)
+		{
+			if (antList[i]->NumCellsFilled() > bestVal)
+			{
+				bestVal = antList[i]->NumCellsFilled();
+				iBest = i;
+			}
+		}
+		
+		// === PHASE 3: SOLUTION TRACKING ===
+		// Update iteration-best (best in this iteration)
+		iterationBest.Copy(antList[iBest]->GetSolution());
+		iterationBestScore = bestVal;
 	}
+	int bestVal = iterationBestScore;
 	
-	// === PHASE 3: SOLUTION TRACKING ===
-	// Update iteration-best (best in this iteration)
-	iterationBest.Copy(antList[iBest]->GetSolution());
-	iterationBestScore = bestVal;
+	// Record where the ants failed, before the next construction reuses them
+	if (heatmap.Enabled())
+		RecordFailures();
+	// Ant count of the next iteration
+	antCount.Update(bestVal, iterationTimer.Elapsed());
 	
 	// Calculate pheromone value for this iteration's best
 	float pherToAdd = PherAdd(bestVal);
@@ -274,6 +443,81 @@ void SubColony::RunIteration(const Board& puzzle)
 		bestSolScore = iterationBestScore;
 		bestPher = pherToAdd;
 	}
+	
+	// === PHASE 4: ELITE ARCHIVE ===
+	if (elites.Enabled())
+	{
+		elites.Offer(iterationBest, iterationBestScore);
+		if (iterationBestScore > bestFoundScore)
+		{
+			bestFoundScore = iterationBestScore;
+			lastImprovement = currentIteration;
+		}
+		else if (eliteStagnation > 0 && currentIteration - lastImprovement >= eliteStagnation)
+			Reinject();
+	}
+	
+	// === PHASE 5: STAGNATION RESTART ===
+	// Before the global update, so the best-so-far is reinforced again at once
+	if (stagnation.Update(iterationBestScore, pher, numCells, numUnits))
+		stagnation.Restart(pher, numCells, numUnits, pher0, bestSol, iterationBest);
+}
+
+// ----------------------------------------------------------------------------
+// RecordFailures: add the cells this iteration's ants left empty to the heatmap
+// ----------------------------------------------------------------------------
+void SubColony::RecordFailures()
+{
+	heatmap.Decay();
+	int active = antCount.Active();
+	float weight = 1.0f / active;
+	for (int i = 0; i < active; i++)
+	{
+		bool scalar = (antEngine == ANT_ENGINE_SCALAR);
+		int filled = scalar ? antList[i]->NumCellsFilled() : population.NumCellsFilled(i);
+		if (filled == numCells)
+			continue;
+		for (int c = 0; c < numCells; c++)
+		{
+			bool empty = scalar ? antList[i]->GetSolution().GetCell(c).Empty() : population.CellEmpty(i, c);
+			if (empty)
+				heatmap.AddFailure(c, weight);
+		}
+	}
+	heatmap.Commit();
+}
+
+// ----------------------------------------------------------------------------
+// Reinject: the colony has not improved for eliteStagnation iterations, so
+// its best-so-far (the solution the global update reinforces) is replaced
+// by a random elite other than the current one
+// ----------------------------------------------------------------------------
+void SubColony::Reinject()
+{
+	lastImprovement = currentIteration;
+	int n = elites.Size();
+	if (n < 2)
+		return;
+	int k = std::uniform_int_distribution<int>(0, n - 1)(randGen);
+	if (SameFixedCells(elites.Get(k), bestSol))
+		k = (k + 1) % n;
+	bestSol.Copy(elites.Get(k));
+	bestSolScore = elites.Score(k);
+	bestPher = PherAdd(bestSolScore);
+}
+
+const Board& SubColony::GetBestFound() const
+{
+	int k = elites.Best();
+	if (k >= 0 && elites.Score(k) > bestSolScore)
+		return elites.Get(k);
+	return bestSol;
+}
+
+int SubColony::GetBestFoundScore() const
+{
+	int k = elites.Best();
+	return (k >= 0) ? std::max(elites.Score(k), bestSolScore) : bestSolScore;
 }
 
 void SubColony::ReceiveIterationBest(const Board& solution)
@@ -281,6 +525,12 @@ void SubColony::ReceiveIterationBest(const Board& solution)
 	// Store received iteration-best from ring topology
 	// This solution is ONLY used for the three-source pheromone update
 	// It does NOT update our own bestSol (which stays independent, like Algorithm 0)
+	// A repeat of the previously received solution was already deposited: discard it
+	if (SameFixedCells(solution, receivedIterationBest))
+	{
+		receivedIterationBestScore = 0;
+		return;
+	}
 	receivedIterationBest.Copy(solution);
 	receivedIterationBestScore = solution.FixedCellCount();
 }
@@ -290,6 +540,12 @@ void SubColony::ReceiveBestSol(const Board& solution)
 	// Store received best-so-far from random topology
 	// This solution is ONLY used for the three-source pheromone update
 	// It does NOT update our own bestSol (which stays independent, like Algorithm 0)
+	// A partner whose best-so-far has not changed sends it again: discard it
+	if (SameFixedCells(solution, receivedBestSol))
+	{
+		receivedBestSolScore = 0;
+		return;
+	}
 	receivedBestSol.Copy(solution);
 	receivedBestSolScore = solution.FixedCellCount();
 }
@@ -307,7 +563,14 @@ void SubColony::ReceiveBestSol(const Board& solution)
 ParallelSudokuAntSystem::ParallelSudokuAntSystem(int nSubColonies, int numAntsPerColony,
 	float q0, float rho, float pher0, float bestEvap)
 	: numSubColonies(nSubColonies), maxTime(120.0f),
-	  globalBestScore(0), iterationsCompleted(0), communicationOccurred(false), solTime(0.0f), barrier(0), stopFlag(false)
+	  globalBestScore(0), iterationsCompleted(0), communicationOccurred(false), solTime(0.0f), 
+	  variant(VARIANT_ACS), antOrdering(ORDER_SEQUENTIAL),
+	  deterministic(false), masterSeed(0), maxIterations(0), maxAntSteps(0), iterationLimit(0),
+	  finisher(nullptr), finisherGap(0),
+	  islands(nullptr), haveIslandIterationBest(false), haveIslandBestSol(false),
+	  barrier(0), barrierGeneration(0), stopFlag(false),
+	  stepColony(0), stepRound(0), totalColonySteps(0),
+	  poolThreads(-1), parkedColonies(0), finishedColonies(0)
 {
 	// Create N independent sub-colonies
 	// Note: rho is used for both standard ACS global update and communication update
@@ -316,6 +579,10 @@ ParallelSudokuAntSystem::ParallelSudokuAntSystem(int nSubColonies, int numAntsPe
 		subColonies.push_back(new SubColony(i, numAntsPerColony, q0, rho, pher0, bestEvap));
 	}
 	
+	// Communication buffers, reused by every exchange
+	commBoards = std::vector<Board>(numSubColonies);
+	matchArray.resize(numSubColonies);
+	
 	// Initialize master random generator (for random topology matching)
 	std::random_device rd;
 	masterRandGen = std::mt19937(rd());
@@ -325,15 +592,182 @@ ParallelSudokuAntSystem::~ParallelSudokuAntSystem()
 {
 	for (auto colony : subColonies)
 		delete colony;
+	if (finisher != nullptr)
+		delete finisher;
+}
+
+void ParallelSudokuAntSystem::SetVariant(PheromoneVariant v)
+{
+	variant = v;
+	for (auto colony : subColonies)
+		colony->SetVariant(v);
+}
+
+void ParallelSudokuAntSystem::Reset(int order)
+{
+	for (auto colony : subColonies)
+		colony->Reset(order);
 }
 
-std::vector<int> ParallelSudokuAntSystem::GenerateMatchArray()
+void ParallelSudokuAntSystem::SetSeed(uint64_t seed)
+{
+	deterministic = true;
+	masterSeed = seed;
+}
+
+// ----------------------------------------------------------------------------
+// PrepareRun: Seeds and iteration limit for a new solve
+// In deterministic mode the master generator and every colony are seeded
+// from the SplitMix64 sequence of the master seed
+// ----------------------------------------------------------------------------
+void ParallelSudokuAntSystem::PrepareRun(const Board& puzzle)
+{
+	if (deterministic)
+	{
+		uint64_t state = masterSeed;
+		masterRandGen.seed((uint32_t)SplitMix64(state));
+		for (auto colony : subColonies)
+			colony->Seed(SplitMix64(state));
+	}
+	long long antStepsPerRound = 0;
+	for (auto colony : subColonies)
+		antStepsPerRound += (long long)colony->GetNumAnts() * puzzle.CellCount();
+	iterationLimit = IterationLimit(maxIterations, maxAntSteps, antStepsPerRound);
+}
+
+void ParallelSudokuAntSystem::SetPrior(PheromonePrior p)
+{
+	for (auto colony : subColonies)
+		colony->SetPrior(p);
+}
+
+void ParallelSudokuAntSystem::SetAntOrdering(AntOrdering o)
+{
+	antOrdering = o;
+	for (auto colony : subColonies)
+		colony->SetAntOrdering(o);
+}
+
+void ParallelSudokuAntSystem::SetAntEngine(AntEngine e)
+{
+	for (auto colony : subColonies)
+		colony->SetAntEngine(e);
+}
+
+void ParallelSudokuAntSystem::SetAntBacktracking(int depth, int budget)
+{
+	for (auto colony : subColonies)
+		colony->SetAntBacktracking(depth, budget);
+}
+
+void ParallelSudokuAntSystem::SetAntProbing(int maxCandidates)
+{
+	for (auto colony : subColonies)
+		colony->SetAntProbing(maxCandidates);
+}
+
+void ParallelSudokuAntSystem::SetEliteArchive(int size, float distancePercent, int stagnation)
+{
+	for (auto colony : subColonies)
+		colony->SetEliteArchive(size, distancePercent, stagnation);
+}
+
+void ParallelSudokuAntSystem::SetStagnation(int window, float concentration, RestartAction action)
+{
+	for (auto colony : subColonies)
+		colony->SetStagnation(window, concentration, action);
+}
+
+void ParallelSudokuAntSystem::SetHeatmap(bool on, float decay, float startBias)
+{
+	for (auto colony : subColonies)
+		colony->SetHeatmap(on, decay, startBias);
+}
+
+void ParallelSudokuAntSystem::GetHeatmap(std::vector<float>& heat) const
+{
+	heat.clear();
+	if (subColonies.empty() || !subColonies[0]->GetHeatmap().Enabled())
+		return;
+	int cells = subColonies[0]->GetHeatmap().CellCount();
+	heat.assign(cells, 0.0f);
+	for (auto colony : subColonies)
+	{
+		for (int c = 0; c < cells; c++)
+			heat[c] += colony->GetHeatmap().Heat(c);
+	}
+	for (int c = 0; c < cells; c++)
+		heat[c] /= subColonies.size();
+}
+
+void ParallelSudokuAntSystem::SetAdaptiveAnts(int minAnts, float maxIterationTime)
+{
+	for (auto colony : subColonies)
+		colony->SetAdaptiveAnts(minAnts, maxIterationTime);
+}
+
+float ParallelSudokuAntSystem::GetMeanAnts() const
+{
+	float sum = 0.0f;
+	for (auto colony : subColonies)
+		sum += colony->GetMeanAnts();
+	return subColonies.empty() ? 0.0f : sum / subColonies.size();
+}
+
+void ParallelSudokuAntSystem::SetFinisher(int gap, float maxTime, int stepLimit)
+{
+	if (finisher != nullptr)
+		delete finisher;
+	finisher = (gap > 0) ? new ExactFinisher(maxTime, stepLimit) : nullptr;
+	finisherGap = gap;
+}
+
+// ----------------------------------------------------------------------------
+// ShouldCommunicate: Communication schedule
+// Before iteration 200: communicate every 100 iterations (at 100, 200)
+// After iteration 200: communicate every 10 iterations (at 210, 220, etc.)
+// Never with a single colony (it then behaves like Algorithm 0), unless it
+// is one island of several
+// ----------------------------------------------------------------------------
+bool ParallelSudokuAntSystem::ShouldCommunicate(int iter)
+{
+	if (numSubColonies <= 1 && islands == nullptr)
+		return false;
+	if (iter < 200)
+		return (iter % 100 == 0);
+	return (iter % 10 == 0);
+}
+
+// ----------------------------------------------------------------------------
+// IsSyncPoint: Deterministic mode only - iterations at which all colonies
+// meet and the master decides whether to stop (every 10 iterations, which
+// includes every communication iteration)
+// ----------------------------------------------------------------------------
+bool ParallelSudokuAntSystem::IsSyncPoint(int iter)
+{
+	return deterministic && (iter % 10 == 0);
+}
+
+// ----------------------------------------------------------------------------
+// DecideStop: Deterministic mode stop decision at a sync point - any colony
+// complete, or the time limit passed
+// ----------------------------------------------------------------------------
+void ParallelSudokuAntSystem::DecideStop()
+{
+	for (int i = 0; i < numSubColonies; i++)
+	{
+		if (subColonies[i]->GetBestSolScore() == subColonies[i]->GetBestSol().CellCount())
+			stopFlag.store(true);
+	}
+	if (solutionTimer.Elapsed() >= maxTime || (islands != nullptr && islands->Solved()))
+		stopFlag.store(true);
+}
+
+void ParallelSudokuAntSystem::GenerateMatchArray()
 {
 	// Generate a random permutation of colony IDs
-	std::vector<int> matchArray(numSubColonies);
 	std::iota(matchArray.begin(), matchArray.end(), 0); // Fill with 0, 1, 2, ..., n-1
 	std::shuffle(matchArray.begin(), matchArray.end(), masterRandGen);
-	return matchArray;
 }
 
 // ============================================================================
@@ -343,10 +777,13 @@ std::vector<int> ParallelSudokuAntSystem::GenerateMatchArray()
 // This ensures every colony receives fresh information from a neighbor
 // 
 // Example with 4 colonies:  0 → 1 → 2 → 3 → 0 (ring)
+//
+// In island mode colony 0 receives from the previous island instead (once
+// that island has published), so the ring runs through all processes
 // ============================================================================
 void ParallelSudokuAntSystem::CommunicateRingTopology()
 {
-	std::vector<Board> iterationBests(numSubColonies);
+	std::vector<Board>& iterationBests = commBoards;
 	
 	// --- STEP 1: Collect all iteration-best solutions ---
 	for (int i = 0; i < numSubColonies; i++)
@@ -358,7 +795,10 @@ void ParallelSudokuAntSystem::CommunicateRingTopology()
 	for (int i = 0; i < numSubColonies; i++)
 	{
 		int nextId = (i + 1) % numSubColonies;  // Ring wraparound
-		subColonies[nextId]->ReceiveIterationBest(iterationBests[i]);
+		if (nextId == 0 && haveIslandIterationBest)
+			subColonies[0]->ReceiveIterationBest(islandIterationBest);
+		else
+			subColonies[nextId]->ReceiveIterationBest(iterationBests[i]);
 	}
 }
 
@@ -375,10 +815,13 @@ void ParallelSudokuAntSystem::CommunicateRingTopology()
 //   Colony 0 receives from Colony 2  
 //   Colony 3 receives from Colony 0
 //   Colony 1 receives from Colony 3
+//
+// In island mode the first colony of the shuffled order receives the
+// best-so-far of a random other island instead
 // ============================================================================
 void ParallelSudokuAntSystem::CommunicateRandomTopology(const std::vector<int>& matchArray)
 {
-	std::vector<Board> bestSols(numSubColonies);
+	std::vector<Board>& bestSols = commBoards;
 	
 	// --- STEP 1: Collect all best-so-far solutions ---
 	for (int i = 0; i < numSubColonies; i++)
@@ -393,7 +836,10 @@ void ParallelSudokuAntSystem::CommunicateRandomTopology(const std::vector<int>&
 		int fromPos = (i + numSubColonies - 1) % numSubColonies;  // Previous in shuffled order
 		int fromColonyId = matchArray[fromPos];
 		
-		subColonies[colonyId]->ReceiveBestSol(bestSols[fromColonyId]);
+		if (i == 0 && haveIslandBestSol)
+			subColonies[colonyId]->ReceiveBestSol(islandBestSol);
+		else
+			subColonies[colonyId]->ReceiveBestSol(bestSols[fromColonyId]);
 	}
 }
 
@@ -410,7 +856,8 @@ void ParallelSudokuAntSystem::CommunicateRandomTopology(const std::vector<int>&
 // ----------------------------------------------------------------------------
 bool ParallelSudokuAntSystem::CheckTimeout()
 {
-	if (solutionTimer.Elapsed() >= maxTime)
+	// (in island mode also stop once another island has solved the puzzle)
+	if (solutionTimer.Elapsed() >= maxTime || (islands != nullptr && islands->Solved()))
 	{
 		stopFlag.store(true);
 		if (numSubColonies > 1)
@@ -434,7 +881,7 @@ void ParallelSudokuAntSystem::ReportProgress(int colonyId, int iteration, SubCol
 		int globalBest = 0;
 		for (int i = 0; i < numSubColonies; i++)
 		{
-			int score = subColonies[i]->GetBestSolScore();
+			int score = subColonies[i]->GetBestFoundScore();
 			if (score > globalBest)
 				globalBest = score;
 		}
@@ -450,9 +897,12 @@ void ParallelSudokuAntSystem::ReportProgress(int colonyId, int iteration, SubCol
 // ----------------------------------------------------------------------------
 bool ParallelSudokuAntSystem::CheckSolutionFound(SubColony* colony)
 {
-	if (colony->GetBestSolScore() == colony->GetBestSol().CellCount())
+	if (colony->GetBestSolScore() == colony->GetBestSol().CellCount() ||
+	    (finisher != nullptr && finisher->Succeeded()))
 	{
 		stopFlag.store(true);
+		if (islands != nullptr)
+			islands->MarkSolved();
 		if (numSubColonies > 1)
 			commCV.notify_all();  // Notify all threads to stop (only needed for multiple threads)
 		return true;
@@ -464,13 +914,36 @@ bool ParallelSudokuAntSystem::CheckSolutionFound(SubColony* colony)
 // ExecuteMasterThreadTasks: Tasks performed by the last thread to arrive
 // This thread becomes the "master" and performs communication
 // ----------------------------------------------------------------------------
-void ParallelSudokuAntSystem::ExecuteMasterThreadTasks(const Board& puzzle)
+void ParallelSudokuAntSystem::ExecuteMasterThreadTasks(const Board& puzzle, bool exchange)
+{
+	if (exchange)
+		ExchangeSolutions();
+	if (deterministic)
+		DecideStop();
+	
+	// Reset barrier for next communication cycle
+	barrier.store(0);
+	barrierGeneration++;
+	
+	// Release all waiting worker threads
+	commCV.notify_all();
+}
+
+// ----------------------------------------------------------------------------
+// ExchangeSolutions: Both communication topologies, then stop if any colony
+// has a complete solution
+// ----------------------------------------------------------------------------
+void ParallelSudokuAntSystem::ExchangeSolutions()
 {
 	// Mark that communication occurred
 	communicationOccurred = true;
 	
 	// Generate random matching for topology 2
-	std::vector<int> matchArray = GenerateMatchArray();
+	GenerateMatchArray();
+	
+	// Boards of the other islands (island mode)
+	if (islands != nullptr)
+		ExchangeIslands();
 	
 	// --- COMMUNICATION TOPOLOGY 1: Ring (iteration-best) ---
 	CommunicateRingTopology();
@@ -487,12 +960,29 @@ void ParallelSudokuAntSystem::ExecuteMasterThreadTasks(const Board& puzzle)
 			break;
 		}
 	}
+}
+
+// ----------------------------------------------------------------------------
+// ExchangeIslands: Island mode - publish this island's last iteration-best
+// of the ring and its best best-so-far, and fetch the boards the topologies
+// deliver from the other islands (see islandexchange.h)
+// ----------------------------------------------------------------------------
+void ParallelSudokuAntSystem::ExchangeIslands()
+{
+	int best = 0;
+	for (int i = 1; i < numSubColonies; i++)
+	{
+		if (subColonies[i]->GetBestSolScore() > subColonies[best]->GetBestSolScore())
+			best = i;
+	}
+	islands->Publish(subColonies[numSubColonies - 1]->GetIterationBest(), subColonies[best]->GetBestSol());
 	
-	// Reset barrier for next communication cycle
-	barrier.store(0);
+	const Board& shape = subColonies[0]->GetBestSol();
+	haveIslandIterationBest = islands->ReceiveIterationBest(shape, islandIterationBest);
+	haveIslandBestSol = islands->ReceiveBestSol(shape, islandBestSol);
 	
-	// Release all waiting worker threads
-	commCV.notify_all();
+	if (islands->Solved())
+		stopFlag.store(true);
 }
 
 // ----------------------------------------------------------------------------
@@ -501,15 +991,18 @@ void ParallelSudokuAntSystem::ExecuteMasterThreadTasks(const Board& puzzle)
 // ----------------------------------------------------------------------------
 void ParallelSudokuAntSystem::ExecuteWorkerThreadWait(std::unique_lock<std::mutex>& lock)
 {
-	auto predicate = [this]() { return barrier.load() == 0 || stopFlag.load(); };
+	// wait for the end of this cycle: a released thread may already be
+	// counted in the barrier of the next cycle before this one wakes up
+	int generation = barrierGeneration;
+	auto predicate = [this, generation]() { return barrierGeneration != generation || stopFlag.load(); };
 	
 	while (!predicate())
 	{
 		// Timed wait (prevents deadlock if something goes wrong)
 		commCV.wait_for(lock, std::chrono::milliseconds(100), predicate);
 		
-		// Timeout check while waiting
-		if (solutionTimer.Elapsed() >= maxTime && !stopFlag.load())
+		// Timeout check while waiting (deterministic mode waits for the master)
+		if (!deterministic && solutionTimer.Elapsed() >= maxTime && !stopFlag.load())
 		{
 			stopFlag.store(true);
 			barrier.store(0);
@@ -518,11 +1011,26 @@ void ParallelSudokuAntSystem::ExecuteWorkerThreadWait(std::unique_lock<std::mute
 	}
 }
 
+// ----------------------------------------------------------------------------
+// LaunchFinisher: Hand a near-complete colony best to the exact finisher
+// ----------------------------------------------------------------------------
+void ParallelSudokuAntSystem::LaunchFinisher(SubColony* colony, const Board& puzzle, int& lastFinisherScore)
+{
+	if (finisher == nullptr)
+		return;
+	int score = colony->GetBestSolScore();
+	if (score > lastFinisherScore && puzzle.CellCount() - score <= finisherGap)
+	{
+		if (finisher->Launch(puzzle, colony->GetBestSol()))
+			lastFinisherScore = score;
+	}
+}
+
 // ----------------------------------------------------------------------------
 // PerformBarrierSynchronization: Coordinate all threads for communication
 // Implements barrier pattern with master/worker roles
 // ----------------------------------------------------------------------------
-void ParallelSudokuAntSystem::PerformBarrierSynchronization(const Board& puzzle)
+void ParallelSudokuAntSystem::PerformBarrierSynchronization(const Board& puzzle, bool exchange)
 {
 	// Pre-check: Don't enter barrier if stop signal already set
 	if (stopFlag.load())
@@ -546,7 +1054,7 @@ void ParallelSudokuAntSystem::PerformBarrierSynchronization(const Board& puzzle)
 	if (arrived == numSubColonies)
 	{
 		// Last thread to arrive becomes MASTER
-		ExecuteMasterThreadTasks(puzzle);
+		ExecuteMasterThreadTasks(puzzle, exchange);
 	}
 	else
 	{
@@ -583,6 +1091,7 @@ void ParallelSudokuAntSystem::SubColonyWorker(int colonyId, const Board& puzzle)
 	colony->Initialize(puzzle);
 	
 	int iter = 0;
+	int lastFinisherScore = 0;  // colony best at the last finisher launch
 	
 	// === OPTIMIZATION: Use local bool for single thread to avoid atomic overhead ===
 	bool shouldStop = false;
@@ -592,12 +1101,16 @@ void ParallelSudokuAntSystem::SubColonyWorker(int colonyId, const Board& puzzle)
 	while (useLocalStop ? !shouldStop : !stopFlag.load())
 	{
 		// --- STEP 1: Check Termination Conditions ---
-		if (CheckTimeout())
+		// (in deterministic mode the time is only checked at sync points)
+		if (!deterministic && CheckTimeout())
 		{
 			if (useLocalStop)
 				shouldStop = true;
 			break;
 		}
+		// every colony reaches the iteration limit at the same point
+		if (iterationLimit > 0 && iter >= iterationLimit)
+			break;
 		
 		iter++;
 		colony->currentIteration = iter;
@@ -605,44 +1118,29 @@ void ParallelSudokuAntSystem::SubColonyWorker(int colonyId, const Board& puzzle)
 		// --- STEP 2: Run Colony Iteration (Independent Parallel Work) ---
 		colony->RunIteration(puzzle);
 		
+		// --- STEP 2a: Hand near-complete colony bests to the exact finisher ---
+		// (not in deterministic mode: the finisher runs on its own timer)
+		if (!deterministic)
+			LaunchFinisher(colony, puzzle, lastFinisherScore);
+		
 		// --- STEP 3: Pheromone Update (Mutually Exclusive) ---
 		// Either standard Algorithm 0 update OR three-source communication update
 		// Skip communication if only 1 thread (behaves like Algorithm 0)
-		bool shouldCommunicate = false;
-		if (numSubColonies > 1)
-		{
-			// Before iteration 200: communicate every 100 iterations (at 100, 200)
-			// After iteration 200: communicate every 10 iterations (at 210, 220, etc.)
-		if (iter < 200)
-		{
-			// Every 100 iterations: 100, 200
-			shouldCommunicate = (iter % 100 == 0);
-		}
-		else
+		bool shouldCommunicate = ShouldCommunicate(iter);
+		bool syncPoint = shouldCommunicate || IsSyncPoint(iter);
+		
+		if (syncPoint)
 		{
-			// Every 10 iterations: 210, 220, 230, etc.
-			shouldCommunicate = (iter % 10 == 0);
-		}
+			// --- STEP 3a: Communication Phase (Periodic Barrier Synchronization) ---
+			// Also the stop decision in deterministic mode
+			PerformBarrierSynchronization(puzzle, shouldCommunicate);
 		}
-		// If numSubColonies == 1, shouldCommunicate stays false (always use Algorithm 0 update)
 		
 		if (shouldCommunicate)
 		{
-			// --- STEP 3a: Communication Phase (Periodic Barrier Synchronization) ---
-			PerformBarrierSynchronization(puzzle);
-			
 			// --- STEP 3b: Three-Source Communication Pheromone Update ---
 			// Uses: local iteration-best + received iteration-best + received best-so-far
 			colony->UpdatePheromoneWithCommunication();
-			
-			// Check stop flag after synchronization
-			if (useLocalStop)
-			{
-				if (stopFlag.load())  // Still check atomic for timeout from CheckTimeout
-					shouldStop = true;
-			}
-			if (useLocalStop ? shouldStop : stopFlag.load())
-				break;
 		}
 		else
 		{
@@ -652,14 +1150,26 @@ void ParallelSudokuAntSystem::SubColonyWorker(int colonyId, const Board& puzzle)
 			
 			// --- STEP 3d: Decay Best Pheromone (only when bestPher is actually used) ---
 			// bestPher is not used during communication intervals, so decay only here
-			colony->bestPher *= (1.0f - colony->bestEvap);
+			colony->EvaporateBestPher();
+		}
+		
+		if (syncPoint)
+		{
+			// Check stop flag after synchronization
+			if (useLocalStop)
+			{
+				if (stopFlag.load())  // Still check atomic for timeout from CheckTimeout
+					shouldStop = true;
+			}
+			if (useLocalStop ? shouldStop : stopFlag.load())
+				break;
 		}
 		
 		// --- STEP 4: Report Progress (Colony 0 Only) ---
 		ReportProgress(colonyId, iter, colony, puzzle);
 		
 		// --- STEP 5: Check if Solution Found ---
-		if (CheckSolutionFound(colony))
+		if (!deterministic && CheckSolutionFound(colony))
 		{
 			if (useLocalStop)
 				shouldStop = true;
@@ -668,6 +1178,144 @@ void ParallelSudokuAntSystem::SubColonyWorker(int colonyId, const Board& puzzle)
 	}
 }
 
+// ============================================================================
+// WORKER POOL - M:N scheduling of the sub-colonies
+// ============================================================================
+// With more colonies than cores, one thread per colony oversubscribes the
+// machine and the barrier waits on descheduled threads. The pool instead
+// runs a fixed number of threads that take ready colonies from a queue, run
+// one iteration of each and queue them again. A sync point is a phase
+// boundary rather than a barrier: a colony that reaches it is parked, and
+// the thread that parks the last one performs the master tasks and makes
+// all colonies ready again. Each colony goes through the same iterations and
+// exchanges as on its own thread, so seeded runs give the same result.
+// ============================================================================
+int ParallelSudokuAntSystem::PoolSize() const
+{
+	int threads = poolThreads;
+	if (threads < 0)
+	{
+		int hardware = (int)std::thread::hardware_concurrency();
+		threads = (hardware > 0 && numSubColonies > hardware) ? hardware : 0;
+	}
+	return (threads > 0 && threads < numSubColonies) ? threads : 0;
+}
+
+void ParallelSudokuAntSystem::PoolWorker(const Board& puzzle)
+{
+	std::unique_lock<std::mutex> lock(commMutex);
+	for (;;)
+	{
+		// idle until a colony is ready (timed, as the barrier wait)
+		while (readyColonies.empty() && !stopFlag.load() && finishedColonies < numSubColonies)
+		{
+			commCV.wait_for(lock, std::chrono::milliseconds(100));
+			if (!deterministic && solutionTimer.Elapsed() >= maxTime)
+				stopFlag.store(true);
+		}
+		if (stopFlag.load() || finishedColonies == numSubColonies)
+			break;
+		int colonyId = readyColonies.front();
+		readyColonies.pop_front();
+		
+		lock.unlock();
+		ColonyTask task = RunColonyTask(colonyId, puzzle);
+		lock.lock();
+		
+		if (task == TASK_READY)
+		{
+			readyColonies.push_back(colonyId);
+			commCV.notify_one();
+			continue;
+		}
+		if (task == TASK_PARKED)
+			parkedColonies++;
+		else
+			finishedColonies++;
+		if (parkedColonies > 0 && parkedColonies + finishedColonies == numSubColonies)
+			EndPhase();
+		commCV.notify_all();
+	}
+	commCV.notify_all();
+}
+
+// ----------------------------------------------------------------------------
+// RunColonyTask: One iteration of a colony, as in SubColonyWorker, split at
+// the sync point: the task parks the colony there, and its next task
+// completes the iteration after the phase boundary
+// ----------------------------------------------------------------------------
+ParallelSudokuAntSystem::ColonyTask ParallelSudokuAntSystem::RunColonyTask(int colonyId, const Board& puzzle)
+{
+	SubColony* colony = subColonies[colonyId];
+	bool syncPoint = (colonyPhase[colonyId] == COLONY_RESUME);
+	if (colonyPhase[colonyId] == COLONY_NEW)
+		colony->Initialize(puzzle);
+	colonyPhase[colonyId] = COLONY_RUN;
+	
+	if (!syncPoint)
+	{
+		if (!deterministic && CheckTimeout())
+			return TASK_DONE;
+		if (iterationLimit > 0 && colony->currentIteration >= iterationLimit)
+			return TASK_DONE;
+		
+		int iter = ++colony->currentIteration;
+		colony->RunIteration(puzzle);
+		if (!deterministic)
+			LaunchFinisher(colony, puzzle, lastFinisherScores[colonyId]);
+		
+		colonyCommunicate[colonyId] = ShouldCommunicate(iter);
+		if (colonyCommunicate[colonyId] || IsSyncPoint(iter))
+		{
+			colonyPhase[colonyId] = COLONY_PARKED;
+			return TASK_PARKED;
+		}
+	}
+	
+	if (colonyCommunicate[colonyId])
+		colony->UpdatePheromoneWithCommunication();
+	else
+	{
+		colony->UpdatePheromone();
+		colony->EvaporateBestPher();
+	}
+	if (syncPoint && stopFlag.load())
+		return TASK_DONE;
+	
+	ReportProgress(colonyId, colony->currentIteration, colony, puzzle);
+	if (!deterministic && CheckSolutionFound(colony))
+		return TASK_DONE;
+	return TASK_READY;
+}
+
+// ----------------------------------------------------------------------------
+// EndPhase: All running colonies are parked - exchange, stop decision, and
+// release them (called with commMutex held)
+// ----------------------------------------------------------------------------
+void ParallelSudokuAntSystem::EndPhase()
+{
+	bool exchange = false;
+	for (int i = 0; i < numSubColonies; i++)
+	{
+		if (colonyPhase[i] == COLONY_PARKED && colonyCommunicate[i])
+			exchange = true;
+	}
+	if (exchange)
+		ExchangeSolutions();
+	if (deterministic)
+		DecideStop();
+	
+	for (int i = 0; i < numSubColonies; i++)
+	{
+		if (colonyPhase[i] == COLONY_PARKED)
+		{
+			colonyPhase[i] = COLONY_RESUME;
+			readyColonies.push_back(i);
+		}
+	}
+	parkedColonies = 0;
+}
+
 // ============================================================================
 // MAIN SOLVE METHOD - Entry point for parallel algorithm
 // ============================================================================
@@ -686,18 +1334,37 @@ bool ParallelSudokuAntSystem::Solve(const Board& puzzle, float timeLimit)
 	maxTime = (timeLimit > 0) ? timeLimit : 120.0f;
 	
 	solutionTimer.Reset();
+	solutionTimer.Resume();
 	stopFlag.store(false);   // Shared stop signal (atomic)
 	barrier.store(0);        // Synchronization counter (atomic)
 	
 	globalBest.Copy(puzzle);
 	globalBestScore = puzzle.FixedCellCount();
+	if (finisher != nullptr)
+		finisher->Reset();
+	PrepareRun(puzzle);
 	
 	// === THREAD CREATION ===
-	// Launch N worker threads, one per sub-colony
+	// Launch N worker threads, one per sub-colony, or the worker pool
 	std::vector<std::thread> threads;
-	for (int i = 0; i < numSubColonies; i++)
+	int pool = PoolSize();
+	if (pool > 0)
 	{
-		threads.emplace_back(&ParallelSudokuAntSystem::SubColonyWorker, this, i, std::ref(puzzle));
+		readyColonies.clear();
+		for (int i = 0; i < numSubColonies; i++)
+			readyColonies.push_back(i);
+		colonyPhase.assign(numSubColonies, COLONY_NEW);
+		colonyCommunicate.assign(numSubColonies, 0);
+		lastFinisherScores.assign(numSubColonies, 0);
+		parkedColonies = 0;
+		finishedColonies = 0;
+		for (int i = 0; i < pool; i++)
+			threads.emplace_back(&ParallelSudokuAntSystem::PoolWorker, this, std::ref(puzzle));
+	}
+	else
+	{
+		for (int i = 0; i < numSubColonies; i++)
+			threads.emplace_back(&ParallelSudokuAntSystem::SubColonyWorker, this, i, std::ref(puzzle));
 	}
 	
 	// === PARALLEL EXECUTION ===
@@ -710,17 +1377,30 @@ bool ParallelSudokuAntSystem::Solve(const Board& puzzle, float timeLimit)
 	{
 		thread.join();
 	}
+	if (finisher != nullptr)
+		finisher->Stop();
 	
 	// === RESULT COLLECTION ===
-	// Find the best solution across all sub-colonies
+	bool solved = CollectResults(puzzle);
+	solutionTimer.Pause();
+	
+	return solved;
+}
+
+// ----------------------------------------------------------------------------
+// CollectResults: Find the best solution across all sub-colonies
+// Returns true if a complete solution was found
+// ----------------------------------------------------------------------------
+bool ParallelSudokuAntSystem::CollectResults(const Board& puzzle)
+{
 	iterationsCompleted = 0;
 	for (int i = 0; i < numSubColonies; i++)
 	{
 		// Find global best solution
-		if (subColonies[i]->GetBestSolScore() > globalBestScore)
+		if (subColonies[i]->GetBestFoundScore() > globalBestScore)
 		{
-			globalBest.Copy(subColonies[i]->GetBestSol());
-			globalBestScore = subColonies[i]->GetBestSolScore();
+			globalBest.Copy(subColonies[i]->GetBestFound());
+			globalBestScore = subColonies[i]->GetBestFoundScore();
 		}
 		
 		// Track maximum iterations (for reporting)
@@ -730,12 +1410,129 @@ bool ParallelSudokuAntSystem::Solve(const Board& puzzle, float timeLimit)
 		}
 	}
 	
+	// The finisher may have completed a colony's partial solution
+	if (finisher != nullptr && finisher->Succeeded() && globalBestScore < puzzle.CellCount())
+	{
+		globalBest.Copy(finisher->GetSolution());
+		globalBestScore = puzzle.CellCount();
+	}
+	
 	solTime = solutionTimer.Elapsed();
 	
 	// Return true if complete solution found
-	bool solved = (globalBestScore == puzzle.CellCount());
+	return (globalBestScore == puzzle.CellCount());
+}
+
+// ============================================================================
+// RESUMABLE SOLVE - Start / Step / Finish on the calling thread
+// ============================================================================
+// The colonies run round-robin: a round runs one iteration of every colony,
+// and rounds where the schedule calls for communication end with the
+// exchange and the three-source update of every colony, as at the barrier
+// of the threaded solve. The time limit counts only the time inside Step().
+// ============================================================================
+void ParallelSudokuAntSystem::Start(const Board& puzzle, float timeLimit)
+{
+	maxTime = (timeLimit > 0) ? timeLimit : 120.0f;
+	solutionTimer.Reset();
+	stopFlag.store(false);
+	communicationOccurred = false;
 	
-	return solved;
+	stepPuzzle.Copy(puzzle);
+	globalBest.Copy(puzzle);
+	globalBestScore = puzzle.FixedCellCount();
+	if (finisher != nullptr)
+		finisher->Reset();
+	for (auto colony : subColonies)
+		colony->Initialize(stepPuzzle);
+	PrepareRun(stepPuzzle);
+	
+	stepColony = 0;
+	stepRound = 1;
+	totalColonySteps = 0;
+	lastFinisherScores.assign(numSubColonies, 0);
+}
+
+SolveProgress ParallelSudokuAntSystem::Step(int budget)
+{
+	const Board& puzzle = stepPuzzle;
+	solutionTimer.Resume();
+	bool solved = false;
+	int steps = 0;
+	while (!stopFlag.load() && steps < budget)
+	{
+		if (!deterministic && solutionTimer.Elapsed() >= maxTime)
+		{
+			stopFlag.store(true);
+			break;
+		}
+		if (stepColony == 0 && iterationLimit > 0 && stepRound > iterationLimit)
+		{
+			stopFlag.store(true);
+			break;
+		}
+		
+		SubColony* colony = subColonies[stepColony];
+		colony->currentIteration = stepRound;
+		colony->RunIteration(puzzle);
+		if (!deterministic)
+			LaunchFinisher(colony, puzzle, lastFinisherScores[stepColony]);
+		
+		bool shouldCommunicate = ShouldCommunicate(stepRound);
+		if (!shouldCommunicate)
+		{
+			colony->UpdatePheromone();
+			colony->EvaporateBestPher();
+		}
+		steps++;
+		totalColonySteps++;
+		
+		if (!deterministic && CheckSolutionFound(colony))
+		{
+			solved = true;
+			break;
+		}
+		
+		// end of the round: exchange at the schedule points, and in
+		// deterministic mode the stop decision at the sync points
+		if (++stepColony == numSubColonies)
+		{
+			if (shouldCommunicate)
+			{
+				ExchangeSolutions();
+				for (auto c : subColonies)
+					c->UpdatePheromoneWithCommunication();
+			}
+			if (IsSyncPoint(stepRound))
+				DecideStop();
+			stepColony = 0;
+			stepRound++;
+		}
+	}
+	solutionTimer.Pause();
+	
+	SolveProgress progress;
+	progress.bestScore = globalBestScore;
+	for (auto colony : subColonies)
+		progress.bestScore = std::max(progress.bestScore, colony->GetBestFoundScore());
+	if (finisher != nullptr && finisher->Succeeded())
+		progress.bestScore = puzzle.CellCount();
+	// in deterministic mode a completed colony ends the solve only through
+	// the stop decision at the next sync point, as in the threaded solve
+	if (!deterministic || stopFlag.load())
+		solved = solved || progress.bestScore == puzzle.CellCount();
+	progress.state = solved ? SOLVE_SOLVED : (stopFlag.load() ? SOLVE_FAILED : SOLVE_RUNNING);
+	progress.steps = steps;
+	progress.totalSteps = totalColonySteps;
+	progress.elapsed = solutionTimer.Elapsed();
+	return progress;
+}
+
+bool ParallelSudokuAntSystem::Finish()
+{
+	if (finisher != nullptr)
+		finisher->Stop();
+	return CollectResults(stepPuzzle);
 }
 
 
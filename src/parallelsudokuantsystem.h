@@ -1,5 +1,6 @@
 #pragma once
 #include <vector>
+#include <deque>
 #include <random>
 #include <thread>
 #include <mutex>
@@ -10,9 +11,17 @@
 #include "board.h"
 #include "timer.h"
 #include "sudokusolver.h"
+#include "exactfinisher.h"
+#include "pheromonepolicy.h"
+#include "antpopulation.h"
+#include "elitearchive.h"
+#include "stagnation.h"
+#include "failureheatmap.h"
+#include "antcount.h"
 
-// Forward declaration
+// Forward declarations
 class ParallelSudokuAntSystem;
+class IslandExchange;
 
 // Sub-colony class representing one thread's ant colony
 class SubColony : public IAntColony
@@ -39,6 +48,8 @@ private:
 	std::uniform_int_distribution<int> startPosDist;  // For ant starting positions (reused)
 	
 	float **pher; // pheromone matrix
+	int pherCells;  // allocated rows of pher
+	int pherUnits;  // allocated columns of pher
 	int numCells;
 	int numUnits;
 	
@@ -46,9 +57,42 @@ private:
 	float* contributions;
 	bool* hasContribution;
 	
+	PheromoneVariant variant;  // pheromone update rules (see pheromonepolicy.h)
+	PheromonePrior prior;      // initial pheromone (see pheromonepolicy.h)
+	AntOrdering antOrdering;   // cell order of the ants (see sudokuant.h)
+	AntEngine antEngine;       // construction engine (see antpopulation.h)
+	AntPopulation population;  // ants of the population engine
+	std::vector<int> startCells;  // start cells of the population engine's ants
+	StagnationDetector stagnation;  // pheromone restarts (off by default)
+	FailureHeatmap heatmap;    // where this colony's ants fail (off by default)
+	AntCountController antCount;  // ants run per iteration (all of them by default)
+	Timer iterationTimer;
+	int antBacktrackDepth;     // local backtracking of the ants (applied by Reset)
+	int antBacktrackBudget;
+	int antProbeCandidates;    // one-step probing of the ants (applied by Reset)
+	
+	EliteArchive elites;       // good, mutually distant solutions of this colony
+	int eliteSize;             // archive capacity (0 = no archive)
+	float eliteDistance;       // minimum distance between elites, % of the cells
+	int eliteStagnation;       // iterations without improvement before a reinjection (0 = never)
+	int bestFoundScore;        // best iteration-best score so far
+	int lastImprovement;       // iteration in which bestFoundScore last grew
+	
+	// instantiations of the variant's policy, chosen by Initialize (see pheromonepolicy.h)
+	void (SubColony::*runIteration)(const Board& puzzle);
+	void (SubColony::*updatePheromone)();
+	void (SubColony::*updatePheromoneWithCommunication)();
+	template<class Policy> void SelectPolicy();
+	template<class Policy> void RunIterationT(const Board& puzzle);
+	
+	void Reinject();
+	void RecordFailures();
+	
 	void InitPheromone(int numCells, int valuesPerCell);
 	void ClearPheromone();
 	float PherAdd(int numCellsFixed);
+	template<class Policy> void UpdatePheromoneT();
+	template<class Policy> void UpdatePheromoneWithCommunicationT();
 	
 public:
 	int currentIteration;     // Current iteration number (public for access by worker)
@@ -59,25 +103,75 @@ public:
 	~SubColony();
 	
 	// Run one iteration of the ant colony
-	void RunIteration(const Board& puzzle);
+	void RunIteration(const Board& puzzle) { (this->*runIteration)(puzzle); }
 	
 	// Standard Algorithm 0 global pheromone update - called every iteration
-	void UpdatePheromone();
+	void UpdatePheromone() { (this->*updatePheromone)(); }
 	
 	// Communication-based three-source pheromone update - called after exchanges
-	void UpdatePheromoneWithCommunication();
+	void UpdatePheromoneWithCommunication() { (this->*updatePheromoneWithCommunication)(); }
+	
+	// Decay the best pheromone value (after a standard update)
+	void EvaporateBestPher();
+	
+	void SetVariant(PheromoneVariant v) { variant = v; }
+	void SetPrior(PheromonePrior p) { prior = p; }
+	// Restart the colony's random generator from seed
+	void Seed(uint64_t seed);
+	int GetNumAnts() const { return numAnts; }
+	void SetAntOrdering(AntOrdering o)
+	{
+		antOrdering = o;
+		for (auto a : antList)
+			a->SetOrdering(o);
+	}
+	// the population engine uses the sequential cell order
+	void SetAntEngine(AntEngine e) { antEngine = e; }
+	// bounded local backtracking of the scalar ants (see SudokuAnt::SetBacktracking)
+	void SetAntBacktracking(int depth, int budget)
+	{
+		antBacktrackDepth = depth;
+		antBacktrackBudget = budget;
+	}
+	// one-step probing of the scalar ants (see SudokuAnt::SetProbing)
+	void SetAntProbing(int maxCandidates) { antProbeCandidates = maxCandidates; }
+	// elite archive (applied by Initialize)
+	void SetEliteArchive(int size, float distancePercent, int stagnation)
+	{
+		eliteSize = size;
+		eliteDistance = distancePercent;
+		eliteStagnation = stagnation;
+	}
+	// restart the pheromone after window iterations without improvement (0 = off)
+	void SetStagnation(int window, float concentration, RestartAction action)
+	{
+		stagnation.Configure(window, concentration, action);
+	}
+	int GetRestarts() const { return stagnation.Restarts(); }
+	// decaying per-cell failure counts, optionally biasing the start cells (see failureheatmap.h)
+	void SetHeatmap(bool on, float decay, float startBias) { heatmap.Configure(on, decay, startBias); }
+	const FailureHeatmap& GetHeatmap() const { return heatmap; }
+	// adapt the ants run per iteration between minAnts and numAnts (0 = off, see antcount.h)
+	void SetAdaptiveAnts(int minAnts, float maxIterationTime) { antCount.Configure(minAnts, maxIterationTime); }
+	float GetMeanAnts() const { return antCount.MeanAnts(); }
 	
 	// Get results
 	const Board& GetIterationBest() const { return iterationBest; }
 	const Board& GetBestSol() const { return bestSol; }
 	int GetIterationBestScore() const { return iterationBestScore; }
 	int GetBestSolScore() const { return bestSolScore; }
+	// best solution seen: bestSol, or the best elite if a reinjection replaced it
+	const Board& GetBestFound() const;
+	int GetBestFoundScore() const;
 	int GetCurrentIteration() const { return currentIteration; }
 	
 	// Set solutions (for communication)
 	void ReceiveIterationBest(const Board& solution);
 	void ReceiveBestSol(const Board& solution);
 	
+	// Size buffers for puzzles of up to this order (grow only)
+	void Reset(int order);
+	
 	// Reset for new puzzle
 	void Initialize(const Board& puzzle);
 	
@@ -85,7 +179,8 @@ public:
 	inline float Getq0() { return q0; }
 	inline float random() { return randomDist(randGen); }
 	inline float Pher(int i, int j) { return pher[i][j]; }
-	void LocalPheromoneUpdate(int iCell, int iChoice);
+	float **PherMatrix() { return pher; }
+	float Pher0() { return pher0; }
 };
 
 // Parallel Ant Colony System with multiple sub-colonies
@@ -101,18 +196,73 @@ private:
 	int iterationsCompleted;
 	bool communicationOccurred;
 	float solTime;
-	Timer solutionTimer;
+	SliceTimer solutionTimer;
 	
 	std::mt19937 masterRandGen;
 	
+	PheromoneVariant variant;
+	AntOrdering antOrdering;
+	
+	// Deterministic mode (SetSeed): seeds derived from one master seed and
+	// stop decisions taken only at sync points, so results do not depend on
+	// thread timing
+	bool deterministic;
+	uint64_t masterSeed;
+	int maxIterations;          // per colony, 0 = no limit
+	long long maxAntSteps;      // over all colonies, 0 = no limit
+	int iterationLimit;         // limit for the current solve (0 = none)
+	void PrepareRun(const Board& puzzle);
+	bool IsSyncPoint(int iter);
+	void DecideStop();
+	
+	// Optional exact finishing stage shared by all colonies (nullptr = off)
+	ExactFinisher *finisher;
+	int finisherGap;
+	
+	// Island mode (see islandexchange.h): exchange with the other processes (nullptr = off)
+	IslandExchange *islands;
+	Board islandIterationBest;  // received from the previous island
+	Board islandBestSol;        // received from a random other island
+	bool haveIslandIterationBest;
+	bool haveIslandBestSol;
+	void ExchangeIslands();
+	
 	// Synchronization
 	std::mutex commMutex;
 	std::condition_variable commCV;
 	std::atomic<int> barrier;
+	int barrierGeneration;  // completed barrier cycles (guarded by commMutex)
 	std::atomic<bool> stopFlag;
 	
+	// State of the resumable solve (Start/Step/Finish): the colonies run
+	// round-robin on the calling thread, one colony iteration per work unit
+	Board stepPuzzle;
+	int stepColony;                     // next colony to run in the current round
+	int stepRound;                      // current round (= colony iteration number)
+	int totalColonySteps;
+	std::vector<int> lastFinisherScores;  // colony best at its last finisher launch
+	
+	// Worker pool (SetPoolThreads): with more colonies than threads, one
+	// colony iteration is a task and a sync point is a phase boundary
+	enum ColonyPhase { COLONY_NEW, COLONY_RUN, COLONY_PARKED, COLONY_RESUME };
+	enum ColonyTask { TASK_READY, TASK_PARKED, TASK_DONE };
+	int poolThreads;                    // -1 = auto, 0 = one thread per colony
+	std::deque<int> readyColonies;      // colonies waiting for a thread (guarded by commMutex)
+	std::vector<char> colonyPhase;      // ColonyPhase of each colony
+	std::vector<char> colonyCommunicate;  // the colony's sync point is an exchange
+	int parkedColonies;                 // colonies at the phase boundary
+	int finishedColonies;
+	int PoolSize() const;
+	void PoolWorker(const Board& puzzle);
+	ColonyTask RunColonyTask(int colonyId, const Board& puzzle);
+	void EndPhase();
+	
 	// Communication helpers
-	std::vector<int> GenerateMatchArray();
+	bool ShouldCommunicate(int iter);
+	void ExchangeSolutions();
+	std::vector<Board> commBoards;   // solutions in transit (one per colony)
+	std::vector<int> matchArray;     // random topology permutation
+	void GenerateMatchArray();
 	void CommunicateRingTopology();
 	void CommunicateRandomTopology(const std::vector<int>& matchArray);
 	
@@ -123,9 +273,11 @@ private:
 	bool CheckTimeout();
 	void ReportProgress(int colonyId, int iteration, SubColony* colony, const Board& puzzle);
 	bool CheckSolutionFound(SubColony* colony);
-	void PerformBarrierSynchronization(const Board& puzzle);
-	void ExecuteMasterThreadTasks(const Board& puzzle);
+	void PerformBarrierSynchronization(const Board& puzzle, bool exchange);
+	void ExecuteMasterThreadTasks(const Board& puzzle, bool exchange);
 	void ExecuteWorkerThreadWait(std::unique_lock<std::mutex>& lock);
+	void LaunchFinisher(SubColony* colony, const Board& puzzle, int& lastFinisherScore);
+	bool CollectResults(const Board& puzzle);
 	
 public:
 	ParallelSudokuAntSystem(int numSubColonies, int numAntsPerColony, 
@@ -133,9 +285,46 @@ public:
 	~ParallelSudokuAntSystem();
 	
 	virtual bool Solve(const Board& puzzle, float maxTime);
+	// resumable interface; a work unit is one iteration of one sub-colony
+	virtual void Start(const Board& puzzle, float maxTime);
+	virtual SolveProgress Step(int budget);
+	virtual bool Finish();
 	virtual float GetSolutionTime() { return solTime; }
 	virtual const Board& GetSolution() { return globalBest; }
 	int GetIterationsCompleted() { return iterationsCompleted; }
 	bool GetCommunicationOccurred() { return communicationOccurred; }
+	// enable the exact finisher for colony bests within gap cells of complete
+	void SetFinisher(int gap, float maxTime, int stepLimit);
+	void SetVariant(PheromoneVariant v);
+	void SetPrior(PheromonePrior p);
+	void SetAntOrdering(AntOrdering o);
+	void SetAntEngine(AntEngine e);
+	void SetAntBacktracking(int depth, int budget);
+	void SetAntProbing(int maxCandidates);
+	// elite archive of size solutions per colony (0 = off), see elitearchive.h
+	void SetEliteArchive(int size, float distancePercent, int stagnation);
+	// pheromone restarts per colony (window 0 = off), see stagnation.h
+	void SetStagnation(int window, float concentration, RestartAction action);
+	// failure heatmap per colony, see failureheatmap.h
+	void SetHeatmap(bool on, float decay, float startBias);
+	// heat of every cell, averaged over the colonies (empty if off)
+	void GetHeatmap(std::vector<float>& heat) const;
+	// adaptive ant count per colony, see antcount.h
+	void SetAdaptiveAnts(int minAnts, float maxIterationTime);
+	// ants per iteration, averaged over the colonies
+	float GetMeanAnts() const;
+	// keep buffers for puzzles of up to this order (grow only)
+	void Reset(int order);
+	// deterministic mode: colony seeds derived from seed, see PrepareRun
+	void SetSeed(uint64_t seed);
+	// run as one island of a multi-process solve (see islandexchange.h)
+	void SetIsland(IslandExchange *link) { islands = link; }
+	// run the colonies on a pool of n threads (see PoolWorker); -1 = a pool
+	// of one thread per hardware thread when the colonies outnumber them,
+	// 0 = always one thread per colony
+	void SetPoolThreads(int n) { poolThreads = n; }
+	// stop after maxIterations iterations per colony or maxAntSteps ant steps
+	// in total (0 = no limit)
+	void SetBudget(int iterations, long long antSteps) { maxIterations = iterations; maxAntSteps = antSteps; }
 };
 
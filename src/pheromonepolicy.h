@@ -0,0 +1,225 @@
+#pragma once
+/*******************************************************************************
+ * PHEROMONE POLICIES - Compile-time update rules for the ant systems
+ *
+ * The deposit formula, global update, local update and best-pheromone
+ * evaporation are shared by SudokuAntSystem and SubColony. Each policy class
+ * bundles one variant of these rules as static inline functions; the update
+ * loops are templates instantiated once per policy, so there is no virtual
+ * dispatch inside them. A solver selects the instantiation once per update
+ * through its PheromoneVariant.
+ *
+ * Variants:
+ * - ACSPolicy:           standard ACS (Dorigo & Gambardella 1997), the
+ *                        original behaviour
+ * - MMASPolicy:          evaporation on every entry, no local update, and
+ *                        pheromone clamped to [tauMax/(2N), tauMax]
+ *                        (Stutzle & Hoos MAX-MIN bounds)
+ * - IterationBestPolicy: ACS rules, but the global update reinforces the
+ *                        iteration-best solution instead of the best-so-far
+ ******************************************************************************/
+
+#include "board.h"
+#include <string>
+#include <vector>
+#include <algorithm>
+
+enum PheromoneVariant
+{
+	VARIANT_ACS,
+	VARIANT_MMAS,
+	VARIANT_ITERATION_BEST
+};
+
+// Parse a --variant value (acs, mmas or ib)
+inline PheromoneVariant ParsePheromoneVariant(const std::string& name)
+{
+	if (name == "mmas")
+		return VARIANT_MMAS;
+	if (name == "ib")
+		return VARIANT_ITERATION_BEST;
+	return VARIANT_ACS;
+}
+
+// Initial pheromone of the matrix (see ApplyPheromonePrior)
+enum PheromonePrior
+{
+	PRIOR_NONE,		// pher0 everywhere
+	PRIOR_COUNT,	// by the cell's number of candidates
+	PRIOR_PLACES	// by the number of places left for the value in the cell's units
+};
+
+// Parse a --prior value (none, count or places)
+inline PheromonePrior ParsePheromonePrior(const std::string& name)
+{
+	if (name == "count")
+		return PRIOR_COUNT;
+	if (name == "places")
+		return PRIOR_PLACES;
+	return PRIOR_NONE;
+}
+
+struct ACSPolicy
+{
+	// evaporate every entry on a global update (otherwise only reinforced ones)
+	static const bool evaporateAll = false;
+	// deposit from the iteration-best instead of the best-so-far
+	static const bool useIterationBest = false;
+
+	// pheromone = numCells / (numCells - numCellsFixed); a complete solution
+	// counts as half a cell missing, so it still ranks above every other one
+	// without an infinite deposit
+	static inline float Deposit(int numCells, int numCellsFixed)
+	{
+		if (numCellsFixed >= numCells)
+			return 2.0f * numCells;
+		return numCells / (float)(numCells - numCellsFixed);
+	}
+	// tau <- (1-rho)*tau + rho*deposit
+	static inline void Reinforce(float& tau, float rho, float deposit)
+	{
+		tau = tau * (1.0f - rho) + rho * deposit;
+	}
+	static inline void Evaporate(float&, float) {}
+	static inline void Bound(float&, float, float) {}
+	// tau <- 0.9*tau + 0.1*tau0
+	static inline void LocalUpdate(float& tau, float pher0)
+	{
+		tau = tau * 0.9f + pher0 * 0.1f;
+	}
+	static inline void EvaporateBest(float& bestPher, float bestEvap)
+	{
+		bestPher *= (1.0f - bestEvap);
+	}
+};
+
+struct MMASPolicy : public ACSPolicy
+{
+	static const bool evaporateAll = true;
+
+	static inline void Evaporate(float& tau, float rho)
+	{
+		tau *= (1.0f - rho);
+	}
+	// evaporation has already been applied to every entry
+	static inline void Reinforce(float& tau, float rho, float deposit)
+	{
+		tau += rho * deposit;
+	}
+	static inline void Bound(float& tau, float tauMin, float tauMax)
+	{
+		if (tau < tauMin)
+			tau = tauMin;
+		else if (tau > tauMax)
+			tau = tauMax;
+	}
+	static inline void LocalUpdate(float&, float) {}
+};
+
+struct IterationBestPolicy : public ACSPolicy
+{
+	static const bool useIterationBest = true;
+};
+
+/*******************************************************************************
+ * GlobalPheromoneUpdate
+ *
+ * Reinforces the [cell, value] pairs of source with deposit. For policies with
+ * evaporateAll every entry is evaporated first and then clamped to
+ * [tauMax/(2*numUnits), tauMax] with tauMax = deposit.
+ ******************************************************************************/
+template<class Policy>
+inline void GlobalPheromoneUpdate(float **pher, int numCells, int numUnits, const Board& source, float rho, float deposit)
+{
+	if (Policy::evaporateAll)
+	{
+		for (int i = 0; i < numCells; i++)
+			for (int j = 0; j < numUnits; j++)
+				Policy::Evaporate(pher[i][j], rho);
+	}
+	for (int i = 0; i < numCells; i++)
+	{
+		if (source.GetCell(i).Fixed())
+			Policy::Reinforce(pher[i][source.GetCell(i).Index()], rho, deposit);
+	}
+	if (Policy::evaporateAll)
+	{
+		float tauMax = deposit;
+		float tauMin = tauMax / (2.0f * numUnits);
+		for (int i = 0; i < numCells; i++)
+			for (int j = 0; j < numUnits; j++)
+				Policy::Bound(pher[i][j], tauMin, tauMax);
+	}
+}
+
+/*******************************************************************************
+ * ApplyPheromonePrior
+ *
+ * Sets the initial pheromone of the candidates of each open cell from the
+ * propagated puzzle, instead of pher0 everywhere:
+ * - PRIOR_COUNT:  pher0 * numUnits / (candidates of the cell), so the rows
+ *                 of tightly constrained cells start higher and the global
+ *                 update takes longer to override them
+ * - PRIOR_PLACES: pher0 * numUnits / places, where places is the smallest
+ *                 number of cells that can still take the value in the
+ *                 cell's row, column or box, so a value with few places left
+ *                 is preferred where it can go
+ * The other entries keep pher0. One pass over the cells, plus one over the
+ * candidates to count the places per unit and value.
+ ******************************************************************************/
+inline void ApplyPheromonePrior(float **pher, const Board& puzzle, float pher0, PheromonePrior prior)
+{
+	int numCells = puzzle.CellCount();
+	int numUnits = puzzle.GetNumUnits();
+	if (prior == PRIOR_NONE)
+		return;
+
+	// places[unit * numUnits + value] for the rows, then the columns, then the boxes
+	std::vector<int> places;
+	if (prior == PRIOR_PLACES)
+	{
+		places.assign(3 * numUnits * numUnits, 0);
+		for (int i = 0; i < numCells; i++)
+		{
+			const ValueSet& cell = puzzle.GetCell(i);
+			if (cell.Fixed())
+				continue;
+			ValueSet value = ValueSet(numUnits, 1);
+			for (int j = 0; j < numUnits; j++)
+			{
+				if (cell.Contains(value))
+				{
+					places[puzzle.RowForCell(i) * numUnits + j]++;
+					places[(numUnits + puzzle.ColForCell(i)) * numUnits + j]++;
+					places[(2 * numUnits + puzzle.BoxForCell(i)) * numUnits + j]++;
+				}
+				value <<= 1;
+			}
+		}
+	}
+
+	for (int i = 0; i < numCells; i++)
+	{
+		const ValueSet& cell = puzzle.GetCell(i);
+		if (cell.Fixed() || cell.Empty())
+			continue;
+		int count = cell.Count();
+		ValueSet value = ValueSet(numUnits, 1);
+		for (int j = 0; j < numUnits; j++)
+		{
+			if (cell.Contains(value))
+			{
+				if (prior == PRIOR_COUNT)
+					pher[i][j] = pher0 * numUnits / count;
+				else
+				{
+					int p = std::min(places[puzzle.RowForCell(i) * numUnits + j],
+						std::min(places[(numUnits + puzzle.ColForCell(i)) * numUnits + j],
+							places[(2 * numUnits + puzzle.BoxForCell(i)) * numUnits + j]));
+					pher[i][j] = pher0 * numUnits / p;
+				}
+			}
+			value <<= 1;
+		}
+	}
+}
@@ -0,0 +1,153 @@
+/*******************************************************************************
+ * PROBING - Implementation
+ ******************************************************************************/
+
+#include "probing.h"
+#include "boardtrail.h"
+#include "constraintpropagation.h"
+#include "timer.h"
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+// Remove value from cell and propagate: a cell left with one value is set,
+// otherwise the peers are checked, as value may now have a single place left
+// in one of the cell's units
+void CandidateProber::Remove(Board& board, int cell, const ValueSet& value)
+{
+	ValueSet reduced = board.GetCell(cell) - value;
+	if (reduced.Fixed())
+	{
+		SetCellAndPropagate(board, cell, reduced);
+		return;
+	}
+	board.SetCellDirect(cell, reduced);
+	if (reduced.Empty())
+	{
+		board.IncrementInfeasible();
+		return;
+	}
+	int numUnits = board.GetNumUnits();
+	int iBox = board.BoxForCell(cell);
+	int iCol = board.ColForCell(cell);
+	int iRow = board.RowForCell(cell);
+	for (int j = 0; j < numUnits; j++)
+	{
+		int k = board.BoxCell(iBox, j);
+		if (k != cell)
+			PropagateConstraints(board, k);
+		k = board.ColCell(iCol, j);
+		if (k != cell)
+			PropagateConstraints(board, k);
+		k = board.RowCell(iRow, j);
+		if (k != cell)
+			PropagateConstraints(board, k);
+	}
+}
+
+int CandidateProber::Run(Board& board)
+{
+	Timer timer;
+	timer.Reset();
+	stats = ProbeStats();
+
+	int numCells = board.CellCount();
+	int numUnits = board.GetNumUnits();
+	int threads = 1;
+	if (numCells >= minParallelCells)
+	{
+		threads = (numThreads > 0) ? numThreads : (int)std::thread::hardware_concurrency();
+		if (threads < 1)
+			threads = 1;
+	}
+
+	std::vector<Board> scratch(threads);
+	std::vector<BoardTrail> trails(threads);
+	std::vector<std::vector<Removal>> found(threads);
+	std::vector<Removal> removals;
+	std::vector<long long> probes(threads, 0);
+	std::atomic<bool> stop(false);
+
+	// thread t probes cells t, t + threads, ... of its scratch board
+	auto probeCells = [&](int t)
+	{
+		Board& b = scratch[t];
+		BoardTrail& trail = trails[t];
+		Timer threadTimer = timer;
+		for (int cell = t; cell < numCells && !stop; cell += threads)
+		{
+			ValueSet options = b.GetCell(cell);
+			if (options.Empty() || options.Fixed())
+				continue;
+			ValueSet value = ValueSet(numUnits, 1);
+			for (int i = 0; i < numUnits; i++)
+			{
+				if (options.Contains(value))
+				{
+					BoardTrail::Mark mark = trail.GetMark(b);
+					SetCellAndPropagate(b, cell, value);
+					if (b.InfeasibleCellCount() > mark.infeasibleCells)
+						found[t].push_back({ cell, value });
+					trail.Undo(b, mark);
+					++probes[t];
+				}
+				value <<= 1;
+			}
+			if (threadTimer.Elapsed() > maxTime)
+				stop = true;
+		}
+	};
+
+	// probing is preprocessing: charge it to the initial CP time
+	BeginInitialCP();
+	bool changed = true;
+	while (changed && !stop)
+	{
+		++stats.rounds;
+		for (int t = 0; t < threads; t++)
+		{
+			scratch[t].Copy(board);
+			trails[t].Reserve(numUnits);
+			trails[t].Clear();
+			scratch[t].SetObserver(&trails[t]);
+			found[t].clear();
+		}
+		if (threads == 1)
+			probeCells(0);
+		else
+		{
+			std::vector<std::thread> workers;
+			for (int t = 0; t < threads; t++)
+				workers.emplace_back(probeCells, t);
+			for (auto& w : workers)
+				w.join();
+		}
+
+		// apply in cell order, so the result does not depend on the threads
+		removals.clear();
+		for (int t = 0; t < threads; t++)
+			removals.insert(removals.end(), found[t].begin(), found[t].end());
+		std::sort(removals.begin(), removals.end(), [](const Removal& x, const Removal& y)
+		{
+			return x.cell < y.cell || (x.cell == y.cell && x.value.GetBits() < y.value.GetBits());
+		});
+		changed = false;
+		for (const Removal& r : removals)
+		{
+			// an earlier removal of this round may have settled the cell
+			const ValueSet& cell = board.GetCell(r.cell);
+			if (cell.Fixed() || !cell.Contains(r.value))
+				continue;
+			Remove(board, r.cell, r.value);
+			++stats.removals;
+			changed = true;
+		}
+	}
+	EndInitialCP();
+
+	for (int t = 0; t < threads; t++)
+		stats.probes += probes[t];
+	stats.timedOut = stop;
+	stats.time = timer.Elapsed();
+	return stats.removals;
+}
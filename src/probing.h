@@ -0,0 +1,57 @@
+#pragma once
+/*******************************************************************************
+ * PROBING - Singleton arc consistency on the propagated puzzle
+ *
+ * Rules 1 and 2 leave candidates that fail as soon as they are tried. The
+ * prober assigns every candidate of every open cell in turn on a scratch
+ * board, propagates, and removes the candidate from the puzzle if the
+ * propagation empties a cell. Each probe is rolled back with a BoardTrail,
+ * so the scratch board is copied once per round, not once per probe.
+ *
+ * A round probes all cells against the board as it was at the start of the
+ * round; its removals are then applied (with propagation) and the rounds
+ * repeat until one removes nothing or the time limit is reached. Removals
+ * are always sound, so stopping early only leaves the board less reduced.
+ *
+ * On boards of at least minParallelCells cells the cells of a round are
+ * split over numThreads threads, each with its own scratch board.
+ ******************************************************************************/
+
+#include "board.h"
+#include <vector>
+
+struct ProbeStats
+{
+	int rounds;			// probing rounds run
+	long long probes;	// candidates tried
+	int removals;		// candidates removed
+	float time;			// seconds
+	bool timedOut;		// stopped by the time limit before the fixpoint
+};
+
+class CandidateProber
+{
+	int numThreads;		// 0 = one per hardware thread
+	float maxTime;
+	int minParallelCells;
+	ProbeStats stats;
+
+	struct Removal
+	{
+		int cell;
+		ValueSet value;
+	};
+
+	static void Remove(Board& board, int cell, const ValueSet& value);
+
+public:
+	CandidateProber() : numThreads(0), maxTime(1.0f), minParallelCells(256), stats() {}
+
+	void SetThreads(int n) { numThreads = n; }
+	// time limit for the whole stage, in seconds
+	void SetTimeLimit(float secs) { maxTime = secs; }
+
+	// remove the failing candidates of board; returns the number removed
+	int Run(Board& board);
+	const ProbeStats& GetStats() const { return stats; }
+};
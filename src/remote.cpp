@@ -0,0 +1,826 @@
+/*******************************************************************************
+ * REMOTE ISLANDS - Implementation
+ ******************************************************************************/
+
+#include "remote.h"
+#include "timer.h"
+#include <cstring>
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+enum RemoteMessage
+{
+	MSG_HELLO = 1,			// coordinator -> worker: island, islands, time limit, puzzle
+	MSG_PUBLISH,			// worker -> coordinator: iteration-best, best-so-far
+	MSG_ITERATION_BEST,		// coordinator -> worker: from the ring predecessor
+	MSG_BEST_SOL,			// coordinator -> worker: from a random other worker
+	MSG_SOLVED,				// worker -> coordinator: complete solution found
+	MSG_STOP,				// coordinator -> worker: stop the solve
+	MSG_RESULT				// worker -> coordinator: outcome and best board
+};
+
+static const uint32_t maxFrame = 1 << 24;
+
+// ============================================================================
+// ENCODING HELPERS - little-endian integers, varints, frames
+// ============================================================================
+
+static void PutU32(std::vector<uint8_t>& out, uint32_t v)
+{
+	for (int i = 0; i < 4; i++)
+		out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static bool GetU32(const std::vector<uint8_t>& in, size_t& pos, uint32_t& v)
+{
+	if (pos + 4 > in.size())
+		return false;
+	v = 0;
+	for (int i = 0; i < 4; i++)
+		v |= (uint32_t)in[pos + i] << (8 * i);
+	pos += 4;
+	return true;
+}
+
+static void PutFloat(std::vector<uint8_t>& out, float f)
+{
+	uint32_t v;
+	memcpy(&v, &f, sizeof(v));
+	PutU32(out, v);
+}
+
+static bool GetFloat(const std::vector<uint8_t>& in, size_t& pos, float& f)
+{
+	uint32_t v;
+	if (!GetU32(in, pos, v))
+		return false;
+	memcpy(&f, &v, sizeof(f));
+	return true;
+}
+
+static void PutVarint(std::vector<uint8_t>& out, uint32_t v)
+{
+	while (v >= 0x80)
+	{
+		out.push_back((uint8_t)(v | 0x80));
+		v >>= 7;
+	}
+	out.push_back((uint8_t)v);
+}
+
+static bool GetVarint(const std::vector<uint8_t>& in, size_t& pos, uint32_t& v)
+{
+	v = 0;
+	for (int shift = 0; shift < 32; shift += 7)
+	{
+		if (pos >= in.size())
+			return false;
+		uint8_t b = in[pos++];
+		v |= (uint32_t)(b & 0x7f) << shift;
+		if (!(b & 0x80))
+			return true;
+	}
+	return false;
+}
+
+#ifndef _WIN32
+static bool SendAll(int fd, const uint8_t *data, size_t len)
+{
+	while (len > 0)
+	{
+		ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+		if (n <= 0)
+			return false;
+		data += n;
+		len -= n;
+	}
+	return true;
+}
+
+// frame: u32 length of type and payload, u8 type, payload
+static bool SendFrame(int fd, uint8_t type, const std::vector<uint8_t>& payload)
+{
+	std::vector<uint8_t> header;
+	PutU32(header, (uint32_t)payload.size() + 1);
+	header.push_back(type);
+	return SendAll(fd, header.data(), header.size()) && SendAll(fd, payload.data(), payload.size());
+}
+
+// Collects the bytes of one connection and splits them into frames
+class FrameReader
+{
+	std::vector<uint8_t> buffer;
+	size_t start = 0;
+
+public:
+	// read what is available; false once the connection is closed or broken
+	bool Fill(int fd)
+	{
+		uint8_t chunk[65536];
+		ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+		if (n <= 0)
+			return false;
+		// drop the frames already consumed, so that a reader polled while
+		// frames keep arriving only holds the unread tail
+		if (start > 0)
+		{
+			buffer.erase(buffer.begin(), buffer.begin() + start);
+			start = 0;
+		}
+		buffer.insert(buffer.end(), chunk, chunk + n);
+		return true;
+	}
+	// next complete frame; false if there is none (or it is malformed)
+	bool Next(uint8_t& type, std::vector<uint8_t>& payload, bool& malformed)
+	{
+		size_t pos = start;
+		uint32_t length;
+		malformed = false;
+		if (!GetU32(buffer, pos, length))
+			return false;
+		if (length == 0 || length > maxFrame)
+		{
+			malformed = true;
+			return false;
+		}
+		if (buffer.size() - pos < length)
+			return false;
+		type = buffer[pos];
+		payload.assign(buffer.begin() + pos + 1, buffer.begin() + pos + length);
+		start = pos + length;
+		if (start == buffer.size())
+		{
+			buffer.clear();
+			start = 0;
+		}
+		return true;
+	}
+};
+
+// wait for one whole frame on a blocking socket
+static bool ReceiveFrame(int fd, FrameReader& reader, uint8_t& type, std::vector<uint8_t>& payload)
+{
+	bool malformed;
+	while (!reader.Next(type, payload, malformed))
+	{
+		if (malformed || !reader.Fill(fd))
+			return false;
+	}
+	return true;
+}
+#endif
+
+// ============================================================================
+// BOARD STREAM - values-only boards, delta-encoded
+// ============================================================================
+
+void BoardStream::Values(const Board& board, std::vector<uint8_t>& values)
+{
+	values.resize(board.CellCount());
+	for (int i = 0; i < board.CellCount(); i++)
+	{
+		const ValueSet& cell = board.GetCell(i);
+		values[i] = cell.Fixed() ? (uint8_t)(cell.Index() + 1) : 0;
+	}
+}
+
+void BoardStream::ToBoard(const std::vector<uint8_t>& values, const Board& shape, Board& out)
+{
+	out.Copy(shape);
+	int numUnits = shape.GetNumUnits();
+	int fixed = 0;
+	for (int i = 0; i < shape.CellCount(); i++)
+	{
+		int v = values[i];
+		if (v > 0 && v <= numUnits)
+		{
+			out.SetCellDirect(i, ValueSet(numUnits, (uint64_t)1 << (v - 1)));
+			fixed++;
+		}
+		else
+			out.SetCellDirect(i, ValueSet(numUnits, 0));
+	}
+	out.RestoreCounters(fixed, shape.CellCount() - fixed);
+}
+
+// mode byte 0: all values; 1: varint count, then per changed cell a varint
+// gap to the previous changed cell and the new value
+void BoardStream::Encode(const std::vector<uint8_t>& values, std::vector<uint8_t>& out)
+{
+	size_t changed = 0;
+	for (size_t i = 0; i < values.size(); i++)
+		changed += (values[i] != last[i]);
+	// a pair takes at most 3 bytes on boards of up to 4096 cells
+	if (changed * 3 < values.size())
+	{
+		out.push_back(1);
+		PutVarint(out, (uint32_t)changed);
+		size_t next = 0;
+		for (size_t i = 0; i < values.size(); i++)
+		{
+			if (values[i] == last[i])
+				continue;
+			PutVarint(out, (uint32_t)(i - next));
+			out.push_back(values[i]);
+			next = i + 1;
+		}
+	}
+	else
+	{
+		out.push_back(0);
+		out.insert(out.end(), values.begin(), values.end());
+	}
+	last = values;
+}
+
+bool BoardStream::Decode(const std::vector<uint8_t>& in, size_t& pos)
+{
+	if (pos >= in.size())
+		return false;
+	uint8_t mode = in[pos++];
+	if (mode == 0)
+	{
+		if (in.size() - pos < last.size())
+			return false;
+		std::copy(in.begin() + pos, in.begin() + pos + last.size(), last.begin());
+		pos += last.size();
+		return true;
+	}
+	uint32_t count;
+	if (mode != 1 || !GetVarint(in, pos, count))
+		return false;
+	size_t next = 0;
+	for (uint32_t k = 0; k < count; k++)
+	{
+		uint32_t gap;
+		if (!GetVarint(in, pos, gap) || pos >= in.size() || next + gap >= last.size())
+			return false;
+		last[next + gap] = in[pos++];
+		next += gap + 1;
+	}
+	return true;
+}
+
+// ============================================================================
+// WORKER LINK
+// ============================================================================
+
+RemoteWorkerLink::RemoteWorkerLink()
+	: sock(-1), island(0), numIslands(1), maxTime(0.0f), outPending(false), solvedPending(false),
+	  newIterationBest(false), newBestSol(false), stopped(false), quit(false)
+{
+	wakePipe[0] = wakePipe[1] = -1;
+}
+
+RemoteWorkerLink::~RemoteWorkerLink()
+{
+	quit.store(true);
+	Wake();
+	if (net.joinable())
+		net.join();
+#ifndef _WIN32
+	if (sock >= 0)
+		close(sock);
+	for (int i = 0; i < 2; i++)
+	{
+		if (wakePipe[i] >= 0)
+			close(wakePipe[i]);
+	}
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// Connect: open the connection to the coordinator and receive the puzzle
+// ----------------------------------------------------------------------------
+bool RemoteWorkerLink::Connect(const std::string& address)
+{
+#ifdef _WIN32
+	(void)address;
+	return false;
+#else
+	size_t colon = address.rfind(':');
+	if (colon == std::string::npos)
+		return false;
+	std::string host = address.substr(0, colon);
+	std::string port = address.substr(colon + 1);
+
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	addrinfo *addresses = nullptr;
+	if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0)
+		return false;
+	for (addrinfo *ai = addresses; ai != nullptr && sock < 0; ai = ai->ai_next)
+	{
+		sock = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+		if (sock >= 0 && connect(sock, ai->ai_addr, ai->ai_addrlen) != 0)
+		{
+			close(sock);
+			sock = -1;
+		}
+	}
+	freeaddrinfo(addresses);
+	if (sock < 0)
+		return false;
+	int one = 1;
+	setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+	// HELLO: island, number of islands, time limit, puzzle string
+	FrameReader reader;
+	uint8_t type;
+	std::vector<uint8_t> payload;
+	if (!ReceiveFrame(sock, reader, type, payload) || type != MSG_HELLO)
+		return false;
+	size_t pos = 0;
+	uint32_t id, count, length;
+	if (!GetU32(payload, pos, id) || !GetU32(payload, pos, count) || !GetFloat(payload, pos, maxTime) ||
+	    !GetU32(payload, pos, length) || payload.size() - pos < length)
+		return false;
+	island = (int)id;
+	numIslands = (int)count;
+	puzzle.assign(payload.begin() + pos, payload.begin() + pos + length);
+	return true;
+#endif
+}
+
+void RemoteWorkerLink::Start(int numCells)
+{
+#ifndef _WIN32
+	sendIterationBest.Reset(numCells);
+	sendBestSol.Reset(numCells);
+	recvIterationBest.Reset(numCells);
+	recvBestSol.Reset(numCells);
+	if (pipe(wakePipe) == 0)
+		fcntl(wakePipe[1], F_SETFL, O_NONBLOCK);
+	net = std::thread(&RemoteWorkerLink::NetworkThread, this);
+#else
+	(void)numCells;
+#endif
+}
+
+void RemoteWorkerLink::Wake()
+{
+#ifndef _WIN32
+	if (wakePipe[1] >= 0)
+	{
+		char byte = 0;
+		ssize_t ignored = write(wakePipe[1], &byte, 1);
+		(void)ignored;
+	}
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// NetworkThread: receive boards and stop messages, send the outbox
+// ----------------------------------------------------------------------------
+void RemoteWorkerLink::NetworkThread()
+{
+#ifndef _WIN32
+	FrameReader reader;
+	std::vector<uint8_t> iterationBest, bestSol, payload;
+	pollfd fds[2];
+	fds[0].fd = sock;
+	fds[0].events = POLLIN;
+	fds[1].fd = wakePipe[0];
+	fds[1].events = POLLIN;
+	while (!quit.load())
+	{
+		fds[0].revents = fds[1].revents = 0;
+		poll(fds, 2, 100);
+		if (fds[1].revents & POLLIN)
+		{
+			char drain[64];
+			ssize_t ignored = read(wakePipe[0], drain, sizeof(drain));
+			(void)ignored;
+		}
+		if (fds[0].revents & (POLLIN | POLLHUP | POLLERR))
+		{
+			if (!reader.Fill(sock))
+			{
+				stopped.store(true);
+				break;
+			}
+			uint8_t type;
+			bool malformed;
+			while (reader.Next(type, payload, malformed))
+				HandleFrame(type, payload);
+			if (malformed)
+			{
+				stopped.store(true);
+				break;
+			}
+		}
+
+		bool publish, solved;
+		{
+			std::lock_guard<std::mutex> lock(boxMutex);
+			publish = outPending;
+			solved = solvedPending;
+			if (publish)
+			{
+				iterationBest.swap(outIterationBest);
+				bestSol.swap(outBestSol);
+			}
+			outPending = solvedPending = false;
+		}
+		if (publish)
+		{
+			payload.clear();
+			sendIterationBest.Encode(iterationBest, payload);
+			sendBestSol.Encode(bestSol, payload);
+			SendFrame(sock, MSG_PUBLISH, payload);
+		}
+		if (solved)
+			SendFrame(sock, MSG_SOLVED, std::vector<uint8_t>());
+	}
+#endif
+}
+
+void RemoteWorkerLink::HandleFrame(uint8_t type, const std::vector<uint8_t>& payload)
+{
+	size_t pos = 0;
+	if (type == MSG_ITERATION_BEST && recvIterationBest.Decode(payload, pos))
+	{
+		std::lock_guard<std::mutex> lock(boxMutex);
+		inIterationBest = recvIterationBest.Last();
+		newIterationBest = true;
+	}
+	else if (type == MSG_BEST_SOL && recvBestSol.Decode(payload, pos))
+	{
+		std::lock_guard<std::mutex> lock(boxMutex);
+		inBestSol = recvBestSol.Last();
+		newBestSol = true;
+	}
+	else if (type == MSG_STOP)
+		stopped.store(true);
+}
+
+void RemoteWorkerLink::Publish(const Board& iterationBest, const Board& bestSol)
+{
+	std::vector<uint8_t> iterationValues, bestValues;
+	BoardStream::Values(iterationBest, iterationValues);
+	BoardStream::Values(bestSol, bestValues);
+	{
+		std::lock_guard<std::mutex> lock(boxMutex);
+		outIterationBest.swap(iterationValues);
+		outBestSol.swap(bestValues);
+		outPending = true;
+	}
+	Wake();
+}
+
+bool RemoteWorkerLink::ReceiveIterationBest(const Board& shape, Board& out)
+{
+	{
+		std::lock_guard<std::mutex> lock(boxMutex);
+		if (!newIterationBest)
+			return false;
+		scratch = inIterationBest;
+		newIterationBest = false;
+	}
+	BoardStream::ToBoard(scratch, shape, out);
+	return true;
+}
+
+bool RemoteWorkerLink::ReceiveBestSol(const Board& shape, Board& out)
+{
+	{
+		std::lock_guard<std::mutex> lock(boxMutex);
+		if (!newBestSol)
+			return false;
+		scratch = inBestSol;
+		newBestSol = false;
+	}
+	BoardStream::ToBoard(scratch, shape, out);
+	return true;
+}
+
+void RemoteWorkerLink::MarkSolved()
+{
+	{
+		std::lock_guard<std::mutex> lock(boxMutex);
+		solvedPending = true;
+	}
+	Wake();
+}
+
+// ----------------------------------------------------------------------------
+// Finish: flush the outbox, stop the network thread, send the result
+// ----------------------------------------------------------------------------
+void RemoteWorkerLink::Finish(bool success, float time, int iterations, bool communication, const Board& best)
+{
+	quit.store(true);
+	Wake();
+	if (net.joinable())
+		net.join();
+#ifndef _WIN32
+	if (sock < 0)
+		return;
+	std::vector<uint8_t> payload, values;
+	PutU32(payload, success ? 1 : 0);
+	PutFloat(payload, time);
+	PutU32(payload, (uint32_t)iterations);
+	payload.push_back(communication ? 1 : 0);
+	BoardStream stream;
+	stream.Reset(best.CellCount());
+	BoardStream::Values(best, values);
+	stream.Encode(values, payload);
+	SendFrame(sock, MSG_RESULT, payload);
+	close(sock);
+	sock = -1;
+#else
+	(void)success;
+	(void)time;
+	(void)iterations;
+	(void)communication;
+	(void)best;
+#endif
+}
+
+// ============================================================================
+// COORDINATOR
+// ============================================================================
+
+RemoteCoordinator::RemoteCoordinator(int listenPort, int workers, const std::string& puzzle)
+	: port(listenPort), numWorkers(workers), puzzleString(puzzle), solTime(0.0f), iterationsCompleted(0),
+	  communicationOccurred(false), winner(-1), bytesReceived(0), bytesSent(0), boardsRelayed(0),
+	  stepMaxTime(0.0f), stepDone(false), stepSolved(false)
+{
+	std::random_device rd;
+	randGen = std::mt19937(rd());
+}
+
+#ifndef _WIN32
+namespace
+{
+	// coordinator state of one connected worker
+	struct WorkerConnection
+	{
+		int fd = -1;
+		FrameReader reader;
+		BoardStream fromIterationBest, fromBestSol;	// worker -> coordinator
+		BoardStream toIterationBest, toBestSol;		// coordinator -> worker
+		bool done = false;
+		bool success = false;
+		float time = 0.0f;
+		int iterations = 0;
+		bool communication = false;
+		BoardStream result;
+	};
+}
+#endif
+
+// ----------------------------------------------------------------------------
+// Solve: wait (up to maxTime) for the workers, send them the puzzle, then
+// relay boards until every worker has sent its result
+// ----------------------------------------------------------------------------
+bool RemoteCoordinator::Solve(const Board& puzzle, float maxTime)
+{
+	solution.Copy(puzzle);
+	solTime = 0.0f;
+	iterationsCompleted = 0;
+	communicationOccurred = false;
+	winner = -1;
+	bytesReceived = bytesSent = boardsRelayed = 0;
+	error.clear();
+#ifdef _WIN32
+	(void)maxTime;
+	error = "remote mode needs POSIX sockets";
+	return false;
+#else
+	int listener = socket(AF_INET, SOCK_STREAM, 0);
+	int one = 1;
+	setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons((uint16_t)port);
+	if (listener < 0 || bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, numWorkers) != 0)
+	{
+		error = "cannot listen on port " + std::to_string(port);
+		if (listener >= 0)
+			close(listener);
+		return false;
+	}
+
+	// === CONNECT THE WORKERS ===
+	std::vector<WorkerConnection> workers(numWorkers);
+	Timer timer;
+	timer.Reset();
+	int connected = 0;
+	while (connected < numWorkers && timer.Elapsed() < maxTime)
+	{
+		pollfd pfd = { listener, POLLIN, 0 };
+		if (poll(&pfd, 1, 100) > 0)
+		{
+			int fd = accept(listener, nullptr, nullptr);
+			if (fd < 0)
+				continue;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+			workers[connected++].fd = fd;
+		}
+	}
+	close(listener);
+	if (connected < numWorkers)
+	{
+		error = "only " + std::to_string(connected) + " of " + std::to_string(numWorkers) + " workers connected";
+		for (int i = 0; i < connected; i++)
+			close(workers[i].fd);
+		return false;
+	}
+	int numCells = puzzle.CellCount();
+	for (int i = 0; i < numWorkers; i++)
+	{
+		WorkerConnection& w = workers[i];
+		w.fromIterationBest.Reset(numCells);
+		w.fromBestSol.Reset(numCells);
+		w.toIterationBest.Reset(numCells);
+		w.toBestSol.Reset(numCells);
+		w.result.Reset(numCells);
+		std::vector<uint8_t> hello;
+		PutU32(hello, (uint32_t)i);
+		PutU32(hello, (uint32_t)numWorkers);
+		PutFloat(hello, maxTime);
+		PutU32(hello, (uint32_t)puzzleString.size());
+		hello.insert(hello.end(), puzzleString.begin(), puzzleString.end());
+		if (!SendFrame(w.fd, MSG_HELLO, hello))
+			w.done = true;
+	}
+
+	// === RELAY LOOP ===
+	// the workers keep their own time; the coordinator stops them a little
+	// after the limit and gives up on silent ones after a grace period
+	timer.Reset();
+	const float stopGrace = 2.0f;
+	const float resultGrace = 10.0f;
+	bool stopSent = false;
+	std::vector<pollfd> fds;
+	std::vector<int> owner;
+	std::vector<uint8_t> payload, out;
+	auto broadcastStop = [&]()
+	{
+		for (auto& w : workers)
+		{
+			if (!w.done)
+				SendFrame(w.fd, MSG_STOP, std::vector<uint8_t>());
+		}
+		stopSent = true;
+	};
+	std::uniform_int_distribution<int> otherWorker(1, numWorkers > 1 ? numWorkers - 1 : 1);
+	for (;;)
+	{
+		fds.clear();
+		owner.clear();
+		for (int i = 0; i < numWorkers; i++)
+		{
+			if (!workers[i].done)
+			{
+				pollfd pfd = { workers[i].fd, POLLIN, 0 };
+				fds.push_back(pfd);
+				owner.push_back(i);
+			}
+		}
+		if (fds.empty())
+			break;
+		float elapsed = timer.Elapsed();
+		if (!stopSent && elapsed > maxTime + stopGrace)
+			broadcastStop();
+		if (elapsed > maxTime + resultGrace)
+			break;
+		poll(fds.data(), fds.size(), 100);
+
+		for (size_t k = 0; k < fds.size(); k++)
+		{
+			if (!(fds[k].revents & (POLLIN | POLLHUP | POLLERR)))
+				continue;
+			int i = owner[k];
+			WorkerConnection& w = workers[i];
+			if (!w.reader.Fill(w.fd))
+			{
+				w.done = true;
+				continue;
+			}
+			uint8_t type;
+			bool malformed;
+			while (!w.done && w.reader.Next(type, payload, malformed))
+			{
+				size_t pos = 0;
+				if (type == MSG_PUBLISH)
+				{
+					bytesReceived += payload.size();
+					if (!w.fromIterationBest.Decode(payload, pos) || !w.fromBestSol.Decode(payload, pos))
+						continue;
+					if (numWorkers < 2)
+						continue;
+					// ring: iteration-best to the next worker
+					WorkerConnection& next = workers[(i + 1) % numWorkers];
+					out.clear();
+					next.toIterationBest.Encode(w.fromIterationBest.Last(), out);
+					if (!next.done && SendFrame(next.fd, MSG_ITERATION_BEST, out))
+					{
+						bytesSent += out.size();
+						boardsRelayed++;
+					}
+					// random: best-so-far to another worker
+					WorkerConnection& partner = workers[(i + otherWorker(randGen)) % numWorkers];
+					out.clear();
+					partner.toBestSol.Encode(w.fromBestSol.Last(), out);
+					if (!partner.done && SendFrame(partner.fd, MSG_BEST_SOL, out))
+					{
+						bytesSent += out.size();
+						boardsRelayed++;
+					}
+				}
+				else if (type == MSG_SOLVED)
+				{
+					if (!stopSent)
+						broadcastStop();
+				}
+				else if (type == MSG_RESULT)
+				{
+					uint32_t success, iterations;
+					if (GetU32(payload, pos, success) && GetFloat(payload, pos, w.time) &&
+					    GetU32(payload, pos, iterations) && pos < payload.size())
+					{
+						w.communication = payload[pos++] != 0;
+						bool decoded = w.result.Decode(payload, pos);
+						w.success = decoded && success != 0;
+						w.iterations = (int)iterations;
+					}
+					w.done = true;
+				}
+			}
+			if (malformed)
+				w.done = true;
+		}
+	}
+	for (auto& w : workers)
+		close(w.fd);
+
+	// === RESULTS ===
+	Board best;
+	for (int i = 0; i < numWorkers; i++)
+	{
+		WorkerConnection& w = workers[i];
+		communicationOccurred = communicationOccurred || w.communication;
+		if (w.iterations > iterationsCompleted)
+			iterationsCompleted = w.iterations;
+		BoardStream::ToBoard(w.result.Last(), puzzle, best);
+		if (w.success && (winner < 0 || w.time < solTime))
+		{
+			winner = i;
+			solution.Copy(best);
+			solTime = w.time;
+		}
+		else if (winner < 0 && best.FixedCellCount() > solution.FixedCellCount())
+			solution.Copy(best);
+		if (winner < 0 && w.time > solTime)
+			solTime = w.time;
+	}
+	return winner >= 0;
+#endif
+}
+
+void RemoteCoordinator::Start(const Board& puzzle, float maxTime)
+{
+	stepPuzzle.Copy(puzzle);
+	stepMaxTime = maxTime;
+	stepDone = false;
+	stepSolved = false;
+}
+
+SolveProgress RemoteCoordinator::Step(int budget)
+{
+	SolveProgress progress;
+	progress.steps = 0;
+	if (!stepDone && budget > 0)
+	{
+		stepSolved = Solve(stepPuzzle, stepMaxTime);
+		stepDone = true;
+		progress.steps = 1;
+	}
+	progress.state = !stepDone ? SOLVE_RUNNING : (stepSolved ? SOLVE_SOLVED : SOLVE_FAILED);
+	progress.totalSteps = stepDone ? 1 : 0;
+	progress.bestScore = solution.FixedCellCount();
+	progress.elapsed = solTime;
+	return progress;
+}
+
+bool RemoteCoordinator::Finish()
+{
+	return stepSolved;
+}
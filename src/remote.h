@@ -0,0 +1,155 @@
+#pragma once
+/*******************************************************************************
+ * REMOTE ISLANDS - Algorithm 2 over several machines (--coordinator/--worker)
+ *
+ * A coordinator process (--coordinator port --workers n) listens on a TCP
+ * port and waits for n workers (--worker host:port). Each worker runs an
+ * ordinary ParallelSudokuAntSystem on its own sub-colonies as one island;
+ * the coordinator sends every worker the puzzle, its island number and the
+ * time limit, then runs the exchange topology and the global stop:
+ * - a worker publishes the iteration-best of its last sub-colony and its
+ *   best best-so-far at each of its communications
+ * - the coordinator forwards the iteration-best to the next worker of the
+ *   ring and the best-so-far to a random other worker
+ * - the first worker with a complete solution reports it, and the
+ *   coordinator tells all workers to stop
+ * - every worker then sends its result, and the coordinator keeps the
+ *   fastest complete solution (or else the best partial one)
+ *
+ * Exchanges overlap with the colonies' work: a worker's exchange only copies
+ * the boards' values to an outbox and takes the latest received boards from
+ * an inbox; encoding, sending and receiving run on a network thread.
+ *
+ * Boards travel as values only (ant solutions have every cell fixed or
+ * empty): one byte per cell, 0 for an empty cell. Each direction of each
+ * board stream remembers the last board it carried and sends only the
+ * changed cells as (gap, value) pairs, or the whole board when that is
+ * shorter. Frames are a little-endian length, a message type and the
+ * payload.
+ ******************************************************************************/
+
+#include "board.h"
+#include "sudokusolver.h"
+#include "islandexchange.h"
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <cstdint>
+
+// One direction of one board stream: values of the last board carried, and
+// the delta encoding against them
+class BoardStream
+{
+	std::vector<uint8_t> last;	// values of the last board (0 = empty)
+
+public:
+	// numCells cells, all empty
+	void Reset(int numCells) { last.assign(numCells, 0); }
+
+	// values of board: value index + 1 of fixed cells, 0 otherwise
+	static void Values(const Board& board, std::vector<uint8_t>& values);
+	// board of values (shape: any board of the puzzle's size)
+	static void ToBoard(const std::vector<uint8_t>& values, const Board& shape, Board& out);
+
+	// append the encoding of values to out, and remember them
+	void Encode(const std::vector<uint8_t>& values, std::vector<uint8_t>& out);
+	// decode a board at in[pos], advance pos; false if malformed
+	bool Decode(const std::vector<uint8_t>& in, size_t& pos);
+	const std::vector<uint8_t>& Last() const { return last; }
+};
+
+// Worker side: the island's exchange with the coordinator
+class RemoteWorkerLink : public IslandExchange
+{
+	int sock;
+	int wakePipe[2];			// wakes the network thread for the outbox
+	int island;
+	int numIslands;
+	float maxTime;
+	std::string puzzle;
+
+	std::thread net;
+	std::mutex boxMutex;
+	std::vector<uint8_t> outIterationBest;	// outbox (values)
+	std::vector<uint8_t> outBestSol;
+	bool outPending;
+	bool solvedPending;
+	std::vector<uint8_t> inIterationBest;	// inbox (values)
+	std::vector<uint8_t> inBestSol;
+	bool newIterationBest;
+	bool newBestSol;
+	std::atomic<bool> stopped;	// stop from the coordinator, or connection lost
+	std::atomic<bool> quit;
+	std::vector<uint8_t> scratch;	// Publish/Receive values, exchanging thread only
+
+	// network thread state
+	BoardStream sendIterationBest, sendBestSol, recvIterationBest, recvBestSol;
+	void NetworkThread();
+	void HandleFrame(uint8_t type, const std::vector<uint8_t>& payload);
+	void Wake();
+
+public:
+	RemoteWorkerLink();
+	~RemoteWorkerLink();
+
+	// connect to host:port and wait for the puzzle; false on failure
+	bool Connect(const std::string& address);
+	int Island() const { return island; }
+	int NumIslands() const { return numIslands; }
+	float MaxTime() const { return maxTime; }
+	const std::string& Puzzle() const { return puzzle; }
+
+	// start the network thread (before the solve)
+	void Start(int numCells);
+	// stop the network thread and send the result of the solve
+	void Finish(bool success, float time, int iterations, bool communication, const Board& best);
+
+	virtual void Publish(const Board& iterationBest, const Board& bestSol);
+	virtual bool ReceiveIterationBest(const Board& shape, Board& out);
+	virtual bool ReceiveBestSol(const Board& shape, Board& out);
+	virtual void MarkSolved();
+	virtual bool Solved() const { return stopped.load(std::memory_order_relaxed); }
+};
+
+// Coordinator side: a solver whose colonies run in the connected workers
+class RemoteCoordinator : public SudokuSolver
+{
+	int port;
+	int numWorkers;
+	std::string puzzleString;	// sent to the workers, who propagate it themselves
+	Board solution;
+	float solTime;
+	int iterationsCompleted;
+	bool communicationOccurred;
+	int winner;					// worker that found the solution (-1 = none)
+	long long bytesReceived;	// board traffic, for the metrics
+	long long bytesSent;
+	long long boardsRelayed;
+	std::mt19937 randGen;
+	std::string error;
+	Board stepPuzzle;
+	float stepMaxTime;
+	bool stepDone;
+	bool stepSolved;
+
+public:
+	RemoteCoordinator(int port, int numWorkers, const std::string& puzzleString);
+
+	virtual bool Solve(const Board& puzzle, float maxTime);
+	// resumable interface; the whole distributed solve is one work unit
+	virtual void Start(const Board& puzzle, float maxTime);
+	virtual SolveProgress Step(int budget);
+	virtual bool Finish();
+	virtual float GetSolutionTime() { return solTime; }
+	virtual const Board& GetSolution() { return solution; }
+	int GetIterationsCompleted() const { return iterationsCompleted; }
+	bool GetCommunicationOccurred() const { return communicationOccurred; }
+	int GetWinner() const { return winner; }
+	long long GetBytesReceived() const { return bytesReceived; }
+	long long GetBytesSent() const { return bytesSent; }
+	long long GetBoardsRelayed() const { return boardsRelayed; }
+	const std::string& GetError() const { return error; }
+};
@@ -15,6 +15,7 @@
  * - Algorithm 0: Single-threaded Ant Colony System (ACS)
  * - Algorithm 1: Backtracking search
  * - Algorithm 2: Parallel ACS with multiple sub-colonies
+ * - --alg auto: pick one of the above from a cheap pre-solve analysis
  ******************************************************************************/
 
 #include "sudokuantsystem.h"
@@ -24,11 +25,25 @@
 #include "board.h"
 #include "arguments.h"
 #include "constraintpropagation.h"
+#include "difficultyestimator.h"
+#include "blankgrid.h"
+#include "tuner.h"
+#include "timer.h"
+#include "allocationcounter.h"
+#include "batchsolver.h"
+#include "probing.h"
+#include "islands.h"
+#include "remote.h"
+#include "parallelpropagation.h"
+#include "bitboard.h"
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <iomanip>
 #include <sstream>
+#include <thread>
+#include <map>
+#include <algorithm>
 using namespace std;
 
 static string JsonEscape(const string &input)
@@ -109,10 +124,212 @@ string ReadFile( string fileName )
 	}
 }
 
+/*******************************************************************************
+ * RunTuning - Race parameter configurations on a corpus (--tune corpusfile)
+ * 
+ * The corpus file lists one puzzle per line, either as a path to a puzzle
+ * file or as a puzzle string. Instances are grouped by order and each size
+ * class is raced separately; the result is written as a config file that
+ * the solver loads with --config.
+ ******************************************************************************/
+int RunTuning( Arguments &a, const string &corpusFile )
+{
+	TunerSettings settings;
+	settings.alg = a.GetArg("alg", 0);
+	settings.numConfigs = a.GetArg("tuneconfigs", 16);
+	settings.trialTimeout = a.GetArg("tunetimeout", 2.0f);
+	settings.minBlocks = a.GetArg("tuneminblocks", 5);
+	settings.maxTrials = a.GetArg("tunebudget", 300);
+	settings.threads = a.GetArg("tunethreads", (int)thread::hardware_concurrency());
+	settings.seed = a.GetArg("tuneseed", 1u);
+	string outFile = a.GetArg(string("tuneout"), string("tuned.cfg"));
+	if ( settings.alg != 0 && settings.alg != 2 )
+	{
+		cerr << "tuning supports alg 0 and alg 2 only" << endl;
+		return 1;
+	}
+	// parallel trials of alg 2 each use several threads already
+	if ( settings.alg == 2 )
+		settings.threads = max(1, settings.threads / 4);
+	settings.threads = max(1, settings.threads);
+
+	ifstream corpus(corpusFile);
+	if ( !corpus.is_open() )
+	{
+		cerr << "could not open corpus: " << corpusFile << endl;
+		return 1;
+	}
+	// boards are built up front: initial propagation is not thread safe
+	map<int, vector<const Board*> > bySize;
+	string line;
+	while ( getline(corpus, line) )
+	{
+		if ( line.empty() || line[0] == '#' )
+			continue;
+		string puzzle = ifstream(line).good() ? ReadFile(line) : line;
+		Board *board = new Board(puzzle);
+		if ( board->CellCount() == 0 )
+		{
+			delete board;
+			continue;
+		}
+		int order = 0;
+		while ( order*order < board->GetNumUnits() )
+			order++;
+		bySize[order].push_back(board);
+	}
+
+	map<int, TunedParameters> results;
+	ParameterRace race(settings);
+	for ( auto &group : bySize )
+	{
+		cout << "racing order " << group.first << " on " << group.second.size() << " instances" << endl;
+		results[group.first] = race.Race(group.second, cout);
+		for ( auto board : group.second )
+			delete board;
+	}
+	if ( !WriteTunedConfig(outFile, results, settings) )
+	{
+		cerr << "could not write " << outFile << endl;
+		return 1;
+	}
+	cout << "wrote " << outFile << endl;
+	return 0;
+}
+
+/*******************************************************************************
+ * RunBatch - Solve many 9x9 puzzles for throughput (--batch puzzlefile)
+ * 
+ * The puzzle file lists one puzzle per line, as a puzzle string ('.' or '0'
+ * for blanks) or a path to a puzzle file. The puzzles are solved by the
+ * bit-sliced batch kernel, with the scalar backtracking search for the ones
+ * it peels off. With --batchcompare the scalar path (initial propagation and
+ * backtracking per puzzle) is timed on the same input for comparison.
+ ******************************************************************************/
+int RunBatch( Arguments &a, const string &puzzleFile )
+{
+	int maxDepth = a.GetArg("batchdepth", 32);
+	int maxRounds = a.GetArg("batchrounds", 1000);
+	float timeOut = a.GetArg("timeout", 5.0f);
+	bool compare = a.GetArg("batchcompare", 0);
+	string outFile = a.GetArg(string("batchout"), string());
+
+	ifstream input(puzzleFile);
+	if ( !input.is_open() )
+	{
+		cerr << "could not open puzzle file: " << puzzleFile << endl;
+		return 1;
+	}
+	vector<string> puzzles;
+	string line;
+	while ( getline(input, line) )
+	{
+		if ( !line.empty() && line.back() == '\r' )
+			line.pop_back();
+		if ( line.empty() || line[0] == '#' )
+			continue;
+		string puzzle = ifstream(line).good() ? ReadFile(line) : line;
+		replace(puzzle.begin(), puzzle.end(), '0', '.');
+		puzzles.push_back(puzzle);
+	}
+
+	ResetCPTiming();
+	vector<BatchResult> results;
+	Timer timer;
+	timer.Reset();
+	int peeled = SolveBatch(puzzles, results, maxDepth, maxRounds, timeOut);
+	float batchTime = timer.Elapsed();
+
+	int solved = 0, unsolvable = 0, invalid = 0, valid = 0;
+	for ( size_t i = 0; i < puzzles.size(); i++ )
+	{
+		if ( results[i].status == BATCH_SOLVED )
+		{
+			solved++;
+			if ( Board(puzzles[i]).CheckSolution(Board(results[i].solution)) )
+				valid++;
+		}
+		else if ( results[i].status == BATCH_UNSOLVABLE )
+			unsolvable++;
+		else if ( results[i].status == BATCH_INVALID )
+			invalid++;
+	}
+	int count = (int)puzzles.size() - invalid;
+	cout << "batch: " << count << " puzzles (" << BATCH_LANES << " lanes), " << solved << " solved ("
+	     << valid << " checked valid), " << unsolvable << " unsolvable, "
+	     << count - solved - unsolvable << " unresolved" << endl;
+	if ( invalid > 0 )
+		cout << "batch: " << invalid << " lines skipped (not 9x9 puzzles)" << endl;
+	cout << "batch: " << peeled << " peeled off to backtracking" << endl;
+	cout << "batch: " << batchTime << " s, " << count / batchTime << " puzzles/s" << endl;
+
+	if ( compare )
+	{
+		int scalarSolved = 0;
+		timer.Reset();
+		BacktrackSearch search;
+		for ( auto &puzzle : puzzles )
+		{
+			if ( puzzle.size() != 81 )
+				continue;
+			Board board(puzzle);
+			if ( search.Solve(board, timeOut) )
+				scalarSolved++;
+		}
+		float scalarTime = timer.Elapsed();
+		cout << "scalar: " << scalarSolved << " solved, " << scalarTime << " s, "
+		     << count / scalarTime << " puzzles/s (batch speedup " << scalarTime / batchTime << "x)" << endl;
+	}
+
+	if ( outFile.length() > 0 )
+	{
+		ofstream out(outFile);
+		if ( !out.is_open() )
+		{
+			cerr << "could not write " << outFile << endl;
+			return 1;
+		}
+		// one line per input puzzle: the solution, or - if there is none
+		for ( auto &r : results )
+			out << (r.status == BATCH_SOLVED ? r.solution : string("-")) << endl;
+	}
+	return (valid == solved) ? 0 : 1;
+}
+
 // ============================================================================
 // SECTION 2: MAIN FUNCTION
 // ============================================================================
 
+/*******************************************************************************
+ * RunAllocationCheck - Assert that solver iterations do not allocate
+ * 
+ * Runs workUnits work units of the resumable solve as a warm-up (this sizes
+ * every buffer and, for alg 2, should include the first exchange), then counts
+ * the heap allocations over another workUnits units. Needs a build with
+ * COUNT_ALLOCATIONS. Returns 0 if there were none, 1 otherwise.
+ ******************************************************************************/
+int RunAllocationCheck( SudokuSolver *solver, const Board &board, int workUnits, float timeOut )
+{
+	if ( !AllocationCountEnabled() )
+	{
+		cerr << "allocation check needs a build with COUNT_ALLOCATIONS (make COUNT_ALLOCATIONS=1)" << endl;
+		return 1;
+	}
+	solver->Start(board, timeOut);
+	SolveProgress warmup = solver->Step(workUnits);
+	long long before = AllocationCount();
+	SolveProgress measured = solver->Step(workUnits);
+	long long allocations = AllocationCount() - before;
+	solver->Finish();
+
+	if ( warmup.state != SOLVE_RUNNING )
+		cout << "allocation check: solve ended during the warm-up, nothing measured" << endl;
+	else
+		cout << "allocation check: " << allocations << " allocations in " << measured.steps
+		     << " work units after " << warmup.steps << " warm-up units" << endl;
+	return (allocations == 0) ? 0 : 1;
+}
+
 /*******************************************************************************
  * main - Entry point for the Sudoku solver
  * 
@@ -131,13 +348,42 @@ int main( int argc, char *argv[] )
 	
 	Arguments a( argc, argv );
 	string puzzleString;
+
+	// Initial propagation to the fixpoint, on threads for large boards (every mode)
+	SetInitialCPFixpoint(a.GetArg("cpfixpoint", 0) != 0);
+	SetInitialCPThreads(a.GetArg("cpthreads", 0));
+	SetInitialCPBitBoard(a.GetArg("cpbitboard", 0) != 0);
+
+	// Tuning mode: race parameter configurations instead of solving
+	string corpusFile = a.GetArg(string("tune"), string());
+	if ( corpusFile.length() > 0 )
+		return RunTuning( a, corpusFile );
+
+	// Batch mode: many 9x9 puzzles for throughput
+	string batchFile = a.GetArg(string("batch"), string());
+	if ( batchFile.length() > 0 )
+		return RunBatch( a, batchFile );
+	BlankGridMode blankMode = BLANK_SEARCH;
+
+	// Worker mode: the puzzle and the time limit come from the coordinator
+	string workerAddress = a.GetArg(string("worker"), string());
+	RemoteWorkerLink workerLink;
+	if ( workerAddress.length() > 0 && !workerLink.Connect(workerAddress) )
+	{
+		cerr << "could not join coordinator " << workerAddress << endl;
+		return 1;
+	}
 	
+	// Option 0: Puzzle sent by the coordinator
+	if ( workerAddress.length() > 0 )
+		puzzleString = workerLink.Puzzle();
 	// Option 1: Generate blank puzzle of specified order
-	if ( a.GetArg("blank", 0) && a.GetArg("order", 0))
+	else if ( a.GetArg("blank", 0) && a.GetArg("order", 0))
 	{
 		int order = a.GetArg("order", 0);
 		if ( order != 0 )
-			puzzleString = string(order*order*order*order,'.');
+			puzzleString = MakeBlankGrid(order);
+		blankMode = ParseBlankGridMode(a.GetArg(string("blankmode"), string("search")));
 	}
 	// Option 2: Read puzzle from command line or file
 	else 
@@ -163,6 +409,29 @@ int main( int argc, char *argv[] )
 	// Initialize board (triggers constraint propagation)
 	Board board(puzzleString);
 
+	// Tuned parameters for this size class (command-line values take precedence)
+	string configFile = a.GetArg(string("config"), string());
+	if ( configFile.length() > 0 )
+	{
+		int order = 0;
+		while ( order*order < board.GetNumUnits() )
+			order++;
+		if ( !a.LoadConfig(configFile, "order" + to_string(order)) )
+			cerr << "could not open config: " << configFile << endl;
+	}
+
+	// Symmetry-broken blank grid: seed a canonical part (or all) of the grid
+	Timer blankTimer;
+	blankTimer.Reset();
+	if ( blankMode == BLANK_PATTERN && a.GetArg("blankseed", 0) != 0 )
+	{
+		std::mt19937 blankRandGen(a.GetArg("blankseed", 0));
+		PatternGrid(board, &blankRandGen);
+	}
+	else
+		SeedBlankGrid(board, blankMode);
+	float blankTime = blankTimer.Elapsed();
+
 	// Parse algorithm parameters
 	int algorithm = a.GetArg("alg", 0);
 	int timeOutSecs = a.GetArg("timeout", -1);
@@ -175,8 +444,65 @@ int main( int argc, char *argv[] )
 	bool verbose = a.GetArg("verbose", 0);
 	bool showInitial = a.GetArg("showinitial", 0);
 	bool jsonOutput = a.GetArg("json", 0);
+	bool autoRoute = (a.GetArg(string("alg"), string()) == "auto");
+	int probeSteps = a.GetArg("probesteps", 2000);
+	string routeLog = a.GetArg(string("routelog"), string());
+	PheromoneVariant variant = ParsePheromoneVariant(a.GetArg(string("variant"), string("acs")));
+	PheromonePrior prior = ParsePheromonePrior(a.GetArg(string("prior"), string("none")));
+	AntOrdering antOrdering = ParseAntOrdering(a.GetArg(string("antorder"), string("seq")));
+	AntEngine antEngine = ParseAntEngine(a.GetArg(string("antengine"), string("scalar")));
+	int antBacktrack = a.GetArg("antbacktrack", 0);
+	int antBacktrackSteps = a.GetArg("antbacktracksteps", 100);
+	int antProbe = a.GetArg("antprobe", 0);
+	bool sac = a.GetArg("sac", 0);
+	float sacTime = a.GetArg("sactime", 1.0f);
+	int sacThreads = a.GetArg("sacthreads", 0);
+	bool valueMajor = a.GetArg("bitboard", 0);
+	bool grid16 = a.GetArg("grid16", 0);
+	int stepBudget = a.GetArg("stepbudget", 0);
+	int allocCheck = a.GetArg("alloccheck", 0);
+	string seedArg = a.GetArg(string("seed"), string());
+	unsigned long long seed = 0;
+	if ( !seedArg.empty() )
+	{
+		stringstream ss(seedArg);
+		if ( seedArg[0] == '-' || !(ss >> seed) || !ss.eof() )
+		{
+			cerr << "invalid --seed: " << seedArg << " (expected an unsigned 64-bit integer)" << endl;
+			return 1;
+		}
+	}
+	int maxIters = a.GetArg("maxiters", 0);
+	long long maxAntSteps = a.GetArg("maxantsteps", 0LL);
+	int eliteSize = a.GetArg("elites", 0);
+	float eliteDistance = a.GetArg("elitedist", 5.0f);
+	int eliteStagnation = a.GetArg("elitestagnation", 500);
+	int stagnationWindow = a.GetArg("stagnation", 0);
+	float concentration = a.GetArg("concentration", 0.0f);
+	RestartAction restartAction = ParseRestartAction(a.GetArg(string("restart"), string("partial")));
+	float heatStart = a.GetArg("heatstart", 0.0f);
+	bool heatmapOn = a.GetArg("heatmap", 0) || heatStart > 0.0f || antOrdering == ORDER_HEAT;
+	float heatDecay = a.GetArg("heatdecay", 0.95f);
+	int minAnts = a.GetArg("minants", 0);
+	float antIterTime = a.GetArg("antitertime", 0.0f);
+	int numIslands = a.GetArg("islands", 0);
+	bool islandPin = a.GetArg("islandpin", 0);
+	int poolThreads = a.GetArg("poolthreads", -1);
+	int coordinatorPort = a.GetArg("coordinator", 0);
+	int numWorkers = a.GetArg("workers", 1);
+	int finisherGap = a.GetArg("finisher", 0);
+	float finisherTime = a.GetArg("finishertime", 1.0f);
+	int finisherSteps = a.GetArg("finishersteps", 0);
 	bool success;
 
+	if ( workerAddress.length() > 0 )
+	{
+		algorithm = 2;
+		timeOutSecs = (int)workerLink.MaxTime();
+	}
+	else if ( coordinatorPort > 0 )
+		algorithm = 2;
+
 	if ( timeOutSecs <= 0 )
 	{
 		int cellCount = board.CellCount();
@@ -190,20 +516,111 @@ int main( int argc, char *argv[] )
 			timeOutSecs = 120;
 	}
 
+	// Probing stage: remove the candidates whose assignment fails at once
+	CandidateProber prober;
+	if ( sac )
+	{
+		prober.SetThreads(sacThreads);
+		prober.SetTimeLimit(sacTime);
+		prober.Run(board);
+		const ProbeStats& ps = prober.GetStats();
+		if ( verbose && !jsonOutput )
+		{
+			cout << "probing: " << ps.removals << " candidates removed, " << ps.probes << " probes in "
+			     << ps.rounds << " rounds, " << ps.time << " s" << (ps.timedOut ? " (time limit)" : "") << endl;
+		}
+	}
+
 	float solTime;
 	Board solution;
-	SudokuSolver *solver;
+	SudokuSolver *solver = nullptr;
 	
 	// ========================================================================
 	// SECTION 2.2: ALGORITHM SELECTION & CONFIGURATION
 	// ========================================================================
 	
-	if ( algorithm == 0 )
-		solver = new SudokuAntSystem( nAnts, q0, rho, 1.0f/board.CellCount(), evap);
+	// Automatic routing: analyse the propagated board and pick the algorithm
+	DifficultyFeatures features;
+	SolverRoute route = ROUTE_ACS;
+	Board probeSolution;
+	if ( autoRoute )
+	{
+		features = EstimateDifficulty(board, probeSteps, probeSolution);
+		route = ChooseRoute(features, (int)thread::hardware_concurrency());
+		algorithm = RouteAlgorithm(route);
+		if ( verbose && !jsonOutput )
+		{
+			cout << "route: " << RouteName(route) << " (fixed " << features.fixedRatio
+			     << ", mean candidates " << features.meanCandidates
+			     << ", probe steps " << features.probeSteps << ")" << endl;
+		}
+	}
+
+	if ( blankMode == BLANK_PATTERN )
+		solver = nullptr; // the pattern layout is a complete grid
+	else if ( autoRoute && (route == ROUTE_PROPAGATION || route == ROUTE_PROBE) )
+		solver = nullptr; // already solved, no solver needed
+	else if ( algorithm == 0 )
+	{
+		SudokuAntSystem *antSystem = new SudokuAntSystem( nAnts, q0, rho, 1.0f/board.CellCount(), evap);
+		antSystem->SetFinisher(finisherGap, finisherTime, finisherSteps);
+		antSystem->SetVariant(variant);
+		antSystem->SetPrior(prior);
+		antSystem->SetAntOrdering(antOrdering);
+		antSystem->SetAntEngine(antEngine);
+		antSystem->SetAntBacktracking(antBacktrack, antBacktrackSteps);
+		antSystem->SetAntProbing(antProbe);
+		antSystem->SetStagnation(stagnationWindow, concentration, restartAction);
+		antSystem->SetHeatmap(heatmapOn, heatDecay, heatStart);
+		antSystem->SetAdaptiveAnts(minAnts, antIterTime);
+		antSystem->SetBudget(maxIters, maxAntSteps);
+		if ( !seedArg.empty() )
+			antSystem->SetSeed(seed);
+		solver = antSystem;
+	}
 	else if ( algorithm == 1 )
-		solver = new BacktrackSearch();
+	{
+		BacktrackSearch *search = new BacktrackSearch();
+		search->SetValueMajor(valueMajor);
+		search->SetGrid16(grid16);
+		solver = search;
+	}
 	else if ( algorithm == 2 )
-		solver = new ParallelSudokuAntSystem( nSubColonies, nAnts, q0, rho, 1.0f/board.CellCount(), evap);
+	{
+		// in island mode every worker process builds its own system
+		auto makeParallel = [&]( int island, int colonies ) -> ParallelSudokuAntSystem*
+		{
+			ParallelSudokuAntSystem *parallelSystem = new ParallelSudokuAntSystem( colonies, nAnts, q0, rho, 1.0f/board.CellCount(), evap);
+			parallelSystem->SetFinisher(finisherGap, finisherTime, finisherSteps);
+			parallelSystem->SetVariant(variant);
+			parallelSystem->SetPrior(prior);
+			parallelSystem->SetAntOrdering(antOrdering);
+			parallelSystem->SetAntEngine(antEngine);
+			parallelSystem->SetAntBacktracking(antBacktrack, antBacktrackSteps);
+			parallelSystem->SetAntProbing(antProbe);
+			parallelSystem->SetEliteArchive(eliteSize, eliteDistance, eliteStagnation);
+			parallelSystem->SetStagnation(stagnationWindow, concentration, restartAction);
+			parallelSystem->SetHeatmap(heatmapOn, heatDecay, heatStart);
+			parallelSystem->SetAdaptiveAnts(minAnts, antIterTime);
+			parallelSystem->SetBudget(maxIters, maxAntSteps);
+			parallelSystem->SetPoolThreads(poolThreads);
+			if ( !seedArg.empty() )
+				parallelSystem->SetSeed(seed + island);
+			return parallelSystem;
+		};
+		if ( coordinatorPort > 0 )
+			solver = new RemoteCoordinator(coordinatorPort, numWorkers, puzzleString);
+		else if ( workerAddress.length() > 0 )
+		{
+			ParallelSudokuAntSystem *parallelSystem = makeParallel(workerLink.Island(), nSubColonies);
+			parallelSystem->SetIsland(&workerLink);
+			solver = parallelSystem;
+		}
+		else if ( numIslands > 1 )
+			solver = new IslandSolver(numIslands, nSubColonies, islandPin, makeParallel);
+		else
+			solver = makeParallel(0, nSubColonies);
+	}
 	else
 	{
 		cerr << "Invalid algorithm: " << algorithm << ". Use 0 (single-thread ACS), 1 (backtracking), or 2 (parallel ACS)." << endl;
@@ -217,13 +634,44 @@ int main( int argc, char *argv[] )
 		cout << board.AsString(false, true) << endl;
 	}
 	
+	if ( allocCheck > 0 && solver != nullptr )
+		return RunAllocationCheck(solver, board, allocCheck, (float)timeOutSecs);
+
 	// ========================================================================
 	// SECTION 2.3: RUN SOLVER
 	// ========================================================================
 	
-	success = solver->Solve(board, (float)timeOutSecs);
-	solution = solver->GetSolution();
-	solTime = solver->GetSolutionTime();
+	if ( solver == nullptr )
+	{
+		// solved by the blank grid pattern, by constraint propagation or by the routing probe
+		success = true;
+		solution.Copy(autoRoute && route == ROUTE_PROBE ? probeSolution : board);
+		solTime = (blankMode == BLANK_PATTERN) ? blankTime : features.probeTime;
+	}
+	else
+	{
+		if ( workerAddress.length() > 0 )
+			workerLink.Start(board.CellCount());
+		if ( stepBudget > 0 )
+		{
+			// run the solve in slices of stepBudget work units
+			solver->Start(board, (float)timeOutSecs);
+			int slices = 0;
+			SolveProgress progress;
+			do
+			{
+				progress = solver->Step(stepBudget);
+				slices++;
+			} while ( progress.state == SOLVE_RUNNING );
+			success = solver->Finish();
+			if ( verbose )
+				cout << "resumable solve: " << slices << " slices, " << progress.totalSteps << " steps" << endl;
+		}
+		else
+			success = solver->Solve(board, (float)timeOutSecs);
+		solution.Copy(solver->GetSolution());
+		solTime = solver->GetSolutionTime();
+	}
 
 	// ========================================================================
 	// SECTION 2.4: SOLUTION VALIDATION & OUTPUT
@@ -259,13 +707,28 @@ int main( int argc, char *argv[] )
 	float avgAntCPTime = antCPTime / numThreads;
 	float totalCPTime = initialCPTime + antCPTime;
 
+	if ( autoRoute && routeLog.length() > 0 )
+		LogRoute(routeLog, features, route, success, solTime);
+
 	int iterations = 0;
 	bool communication = false;
+	vector<float> heat;	// failure heatmap, empty when off
+	float meanAnts = 0.0f;	// ants per iteration, with --minants
+	int islandWinner = -1;	// island that solved the puzzle, with --islands
 	if ( algorithm == 0 )
 	{
 		SudokuAntSystem* antSolver = dynamic_cast<SudokuAntSystem*>(solver);
 		if ( antSolver )
+		{
 			iterations = antSolver->GetIterationsCompleted();
+			meanAnts = antSolver->GetMeanAnts();
+			const FailureHeatmap& heatmap = antSolver->GetHeatmap();
+			if ( heatmap.Enabled() )
+			{
+				for ( int c = 0; c < heatmap.CellCount(); c++ )
+					heat.push_back(heatmap.Heat(c));
+			}
+		}
 	}
 	else if ( algorithm == 2 )
 	{
@@ -274,8 +737,28 @@ int main( int argc, char *argv[] )
 		{
 			iterations = parallelSolver->GetIterationsCompleted();
 			communication = parallelSolver->GetCommunicationOccurred();
+			parallelSolver->GetHeatmap(heat);
+			meanAnts = parallelSolver->GetMeanAnts();
+		}
+		IslandSolver* islandSolver = dynamic_cast<IslandSolver*>(solver);
+		if ( islandSolver )
+		{
+			iterations = islandSolver->GetIterationsCompleted();
+			communication = islandSolver->GetCommunicationOccurred();
+			islandWinner = islandSolver->GetWinner();
+		}
+		RemoteCoordinator* coordinator = dynamic_cast<RemoteCoordinator*>(solver);
+		if ( coordinator )
+		{
+			iterations = coordinator->GetIterationsCompleted();
+			communication = coordinator->GetCommunicationOccurred();
+			islandWinner = coordinator->GetWinner();
+			if ( errorMessage.empty() )
+				errorMessage = coordinator->GetError();
 		}
 	}
+	if ( workerAddress.length() > 0 )
+		workerLink.Finish(success, solTime, iterations, communication, solution);
 	
 	if ( jsonOutput )
 	{
@@ -283,6 +766,8 @@ int main( int argc, char *argv[] )
 		cout << "{";
 		cout << "\"success\":" << (success ? "true" : "false") << ",";
 		cout << "\"algorithm\":" << algorithm << ",";
+		if ( autoRoute )
+			cout << "\"route\":\"" << RouteName(route) << "\",";
 		cout << "\"time\":" << solTime << ",";
 		cout << "\"iterations\":" << iterations << ",";
 		cout << "\"communication\":" << (communication ? "true" : "false") << ",";
@@ -292,6 +777,30 @@ int main( int argc, char *argv[] )
 		cout << "\"cp_ant_avg\":" << avgAntCPTime << ",";
 		cout << "\"cp_ant_total\":" << antCPTime << ",";
 		cout << "\"cp_calls\":" << cpCallCount << ",";
+		if ( sac )
+		{
+			cout << "\"sac_removals\":" << prober.GetStats().removals << ",";
+			cout << "\"sac_probes\":" << prober.GetStats().probes << ",";
+			cout << "\"sac_time\":" << prober.GetStats().time << ",";
+		}
+		if ( minAnts > 0 )
+			cout << "\"mean_ants\":" << meanAnts << ",";
+		if ( numIslands > 1 || coordinatorPort > 0 )
+			cout << "\"island_winner\":" << islandWinner << ",";
+		if ( coordinatorPort > 0 )
+		{
+			RemoteCoordinator* coordinator = dynamic_cast<RemoteCoordinator*>(solver);
+			cout << "\"bytes_received\":" << coordinator->GetBytesReceived() << ",";
+			cout << "\"bytes_sent\":" << coordinator->GetBytesSent() << ",";
+			cout << "\"boards_relayed\":" << coordinator->GetBoardsRelayed() << ",";
+		}
+		if ( !heat.empty() )
+		{
+			cout << "\"heatmap\":[";
+			for ( size_t c = 0; c < heat.size(); c++ )
+				cout << (c > 0 ? "," : "") << heat[c];
+			cout << "],";
+		}
 		cout << "\"cp_total\":" << totalCPTime;
 		cout << "}" << endl;
 		return 0;
@@ -344,6 +853,36 @@ int main( int argc, char *argv[] )
 			}
 		}
 		
+		if ( minAnts > 0 && meanAnts > 0.0f )
+			cout << "mean ants per iteration: " << meanAnts << endl;
+		if ( numIslands > 1 && islandWinner >= 0 )
+			cout << "solved by island " << islandWinner << " of " << numIslands << endl;
+		if ( coordinatorPort > 0 )
+		{
+			RemoteCoordinator* coordinator = dynamic_cast<RemoteCoordinator*>(solver);
+			if ( islandWinner >= 0 )
+				cout << "solved by worker " << islandWinner << " of " << numWorkers << endl;
+			if ( !coordinator->GetError().empty() )
+				cout << "coordinator: " << coordinator->GetError() << endl;
+			cout << "exchange: " << coordinator->GetBoardsRelayed() << " boards relayed, "
+			     << coordinator->GetBytesReceived() << " bytes received, "
+			     << coordinator->GetBytesSent() << " bytes sent" << endl;
+		}
+		
+		if ( !heat.empty() )
+		{
+			// decayed failure rate of each cell, in percent of the ants
+			float scale = 100.0f * (1.0f - heatDecay);
+			int numUnits = board.GetNumUnits();
+			cout << "Failure heatmap (% of ants leaving the cell empty):" << endl;
+			for ( int row = 0; row < numUnits; row++ )
+			{
+				for ( int col = 0; col < numUnits; col++ )
+					cout << setw(4) << (int)(heat[row * numUnits + col] * scale + 0.5f);
+				cout << endl;
+			}
+		}
+		
 		// ====================================================================
 		// COST-BENEFIT ANALYSIS: CONSTRAINT PROPAGATION OVERHEAD
 		// ====================================================================
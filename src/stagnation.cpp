@@ -0,0 +1,72 @@
+/*******************************************************************************
+ * STAGNATION DETECTOR - Implementation
+ ******************************************************************************/
+
+#include "stagnation.h"
+
+void StagnationDetector::Configure(int newWindow, float newMinConcentration, RestartAction newAction)
+{
+	window = newWindow;
+	minConcentration = newMinConcentration;
+	action = newAction;
+}
+
+void StagnationDetector::Reset(int initialScore)
+{
+	bestScore = initialScore;
+	sinceImprovement = 0;
+	restarts = 0;
+}
+
+bool StagnationDetector::Update(int iterationBestScore, float **pher, int numCells, int numUnits)
+{
+	if (window == 0)
+		return false;
+	if (iterationBestScore > bestScore)
+	{
+		bestScore = iterationBestScore;
+		sinceImprovement = 0;
+		return false;
+	}
+	if (++sinceImprovement < window)
+		return false;
+	// the matrix is only scanned once the window has passed
+	return minConcentration <= 0.0f || Concentration(pher, numCells, numUnits) >= minConcentration;
+}
+
+void StagnationDetector::Restart(float **pher, int numCells, int numUnits, float pher0,
+	const Board& bestSol, const Board& iterationBest)
+{
+	for (int i = 0; i < numCells; i++)
+	{
+		if (action == RESTART_PARTIAL)
+		{
+			const ValueSet& best = bestSol.GetCell(i);
+			if (best.Fixed() && best.GetBits() == iterationBest.GetCell(i).GetBits())
+				continue;
+		}
+		for (int j = 0; j < numUnits; j++)
+			pher[i][j] = pher0;
+	}
+	sinceImprovement = 0;
+	++restarts;
+}
+
+float StagnationDetector::Concentration(float **pher, int numCells, int numUnits)
+{
+	float total = 0.0f;
+	for (int i = 0; i < numCells; i++)
+	{
+		float sum = 0.0f;
+		float best = 0.0f;
+		for (int j = 0; j < numUnits; j++)
+		{
+			sum += pher[i][j];
+			if (pher[i][j] > best)
+				best = pher[i][j];
+		}
+		if (sum > 0.0f)
+			total += best / sum;
+	}
+	return total / numCells;
+}
@@ -0,0 +1,66 @@
+#pragma once
+/*******************************************************************************
+ * STAGNATION DETECTOR - Pheromone restarts for a colony that stopped improving
+ *
+ * Once the best pheromone value has decayed, an ACS colony can keep building
+ * the same iteration-best solution until the time limit. The detector counts
+ * the iterations since the best score last improved; after window iterations
+ * without improvement it measures how concentrated the pheromone matrix is
+ * (the mean over the cells of max / sum of the cell's pheromone values) and
+ * reports stagnation once that is at least minConcentration.
+ *
+ * Restart actions:
+ * - RESTART_PARTIAL: reset to pher0 the rows of the cells where the
+ *                    iteration-best and the best-so-far disagree (different
+ *                    values, or no value in the best-so-far)
+ * - RESTART_FULL:    reset the whole matrix to pher0
+ *
+ * Either way the colony keeps its best-so-far solution, which the next
+ * global update reinforces again.
+ ******************************************************************************/
+
+#include "board.h"
+#include <string>
+
+enum RestartAction
+{
+	RESTART_PARTIAL,
+	RESTART_FULL
+};
+
+// Parse a --restart value (partial or full)
+inline RestartAction ParseRestartAction(const std::string& name)
+{
+	if (name == "full")
+		return RESTART_FULL;
+	return RESTART_PARTIAL;
+}
+
+class StagnationDetector
+{
+	int window;				// iterations without improvement (0 = off)
+	float minConcentration;	// 0 = restart on the window alone
+	RestartAction action;
+	int bestScore;
+	int sinceImprovement;
+	int restarts;
+
+public:
+	StagnationDetector() : window(0), minConcentration(0.0f), action(RESTART_PARTIAL),
+		bestScore(0), sinceImprovement(0), restarts(0) {}
+
+	void Configure(int window, float minConcentration, RestartAction action);
+	// start of a solve
+	void Reset(int initialScore);
+	bool Enabled() const { return window > 0; }
+
+	// record one iteration; true if the colony has stagnated
+	bool Update(int iterationBestScore, float **pher, int numCells, int numUnits);
+	// apply the restart action to pher
+	void Restart(float **pher, int numCells, int numUnits, float pher0,
+		const Board& bestSol, const Board& iterationBest);
+	int Restarts() const { return restarts; }
+
+	// mean over the cells of max / sum of the cell's pheromone values
+	static float Concentration(float **pher, int numCells, int numUnits);
+};
@@ -1,22 +1,127 @@
 #include "sudokuant.h"
 #include "sudokuantsystem.h"
 #include "constraintpropagation.h"
+#include "pheromonepolicy.h"
+
+SudokuAnt::~SudokuAnt()
+{
+	if (roulette != nullptr)
+	{
+		delete[] roulette;
+		delete[] rouletteVals;
+	}
+}
+
+void SudokuAnt::Reset(int numUnits)
+{
+	if (backtrackDepth > 0 || probeCandidates > 0)
+		trail.Reserve(numUnits);
+	if ((int)decisions.size() < backtrackDepth)
+		decisions.resize(backtrackDepth);
+	if (numUnits <= rouletteSize)
+		return;
+	if (roulette != nullptr)
+	{
+		delete[] roulette;
+		delete[] rouletteVals;
+	}
+	roulette = new float[numUnits];
+	rouletteVals = new ValueSet[numUnits];
+	rouletteSize = numUnits;
+}
 
 void SudokuAnt::InitSolution(const Board &puzzle, int startCell )
 {
 	sol.Copy(puzzle);
 	iCell = startCell;
 	failCells = 0;
-	if (roulette != nullptr)
+	pher = parent->PherMatrix();
+	pher0 = parent->Pher0();
+	hotPos = 0;
+	Reset(puzzle.GetNumUnits());
+	if (ordering == ORDER_MOST_CONSTRAINED)
 	{
-		delete[] roulette;
-		delete[] rouletteVals;
+		buckets.Init(sol);
+		sol.SetObserver(&buckets);
 	}
-	roulette = new float[puzzle.GetNumUnits()];
-	rouletteVals = new ValueSet[puzzle.GetNumUnits()];
+	else if (ordering == ORDER_SEQUENTIAL && (backtrackDepth > 0 || probeCandidates > 0))
+	{
+		trail.Clear();
+		sol.SetObserver(&trail);
+		firstCell = startCell;
+		steps = 0;
+		pos = 0;
+		firstDecision = 0;
+		numDecisions = 0;
+		backtracksLeft = backtrackBudget;
+	}
+	else
+		sol.SetObserver(nullptr);
+}
+
+// Pick the cell for the next step: the most constrained unvisited cell
+// (empty and fixed cells first), ties broken at random
+int SudokuAnt::NextCell()
+{
+	int b = buckets.LowestBucket();
+	if (b < 0)
+		return -1;
+	int k = 0;
+	if (b > 1)
+	{
+		k = (int)(parent->random() * buckets.BucketSize(b));
+		if (k == buckets.BucketSize(b))
+			k--;
+	}
+	int cell = buckets.CellInBucket(b, k);
+	buckets.Visit(cell);
+	return cell;
+}
+
+// Pick the cell for the next step of the heat order: the hot cells of the
+// heatmap, hottest first, then the other cells sequentially from the start
+// cell
+int SudokuAnt::NextHeatCell()
+{
+	const std::vector<int>& hotCells = heatmap->HotCells();
+	if (hotPos < (int)hotCells.size())
+		return hotCells[hotPos++];
+	// at least one cell is not hotter than the mean
+	while (heatmap->IsHot(iCell))
+		iCell = (iCell + 1 == sol.CellCount()) ? 0 : iCell + 1;
+	int cell = iCell;
+	iCell = (iCell + 1 == sol.CellCount()) ? 0 : iCell + 1;
+	return cell;
 }
 
+template<class Policy>
 void SudokuAnt::StepSolution()
+{
+	if (ordering == ORDER_MOST_CONSTRAINED)
+	{
+		int cell = NextCell();
+		if (cell >= 0)
+			FillCell<Policy>(cell);
+		return;
+	}
+	if (ordering == ORDER_HEAT)
+	{
+		FillCell<Policy>(NextHeatCell());
+		return;
+	}
+	if (backtrackDepth > 0)
+	{
+		StepWithBacktracking<Policy>();
+		return;
+	}
+	FillCell<Policy>(iCell);
+	++iCell;
+	if (iCell == sol.CellCount()) // wrap around
+		iCell = 0;
+}
+
+template<class Policy>
+void SudokuAnt::FillCell(int iCell)
 {
 	if (sol.GetCell(iCell).Empty())
 	{
@@ -24,6 +129,10 @@ void SudokuAnt::StepSolution()
 	}
 	else if ( !sol.GetCell(iCell).Fixed() )
 	{
+		ValueSet options = sol.GetCell(iCell);
+		if (probeCandidates > 0 && ordering == ORDER_SEQUENTIAL && options.Count() <= probeCandidates)
+			options = ProbeOptions(iCell, options);
+
 		// make a choice from the options
 		ValueSet choice = ValueSet(sol.GetNumUnits(), 1);
 		if (parent->random() < parent->Getq0())
@@ -34,7 +143,7 @@ void SudokuAnt::StepSolution()
 
 			for (int i = 0; i < sol.GetNumUnits(); i++)
 			{
-				if (sol.GetCell(iCell).Contains(choice))
+				if (options.Contains(choice))
 				{
 					if (parent->Pher(iCell, i) > maxPher)
 					{
@@ -46,7 +155,7 @@ void SudokuAnt::StepSolution()
 			}
 SetCellAndPropagate(sol, iCell, best);
 			// do local pheromone update here
-			parent->LocalPheromoneUpdate(iCell, best.Index());
+			Policy::LocalUpdate(pher[iCell][best.Index()], pher0);
 		}
 		else
 		{
@@ -55,7 +164,7 @@ SetCellAndPropagate(sol, iCell, best);
 			int numChoices = 0;
 			for (int i = 0; i < sol.GetNumUnits(); i++)
 			{
-				if (sol.GetCell(iCell).Contains(choice))
+				if (options.Contains(choice))
 				{
 					roulette[numChoices] = totPher + parent->Pher(iCell, i);
 					totPher = roulette[numChoices];
@@ -72,14 +181,117 @@ SetCellAndPropagate(sol, iCell, best);
 				{
 				SetCellAndPropagate(sol, iCell, rouletteVals[i]);
 					// do local pheromone update here
-					parent->LocalPheromoneUpdate(iCell, rouletteVals[i].Index());
+					Policy::LocalUpdate(pher[iCell][rouletteVals[i].Index()], pher0);
 					break;
 				}
 			}
 		}
 	}
-	++iCell;
-	if (iCell == sol.CellCount()) // wrap around
-		iCell = 0;
 }
 
+// Candidates of iCell whose assignment empties no cell (all of options if
+// every one does)
+ValueSet SudokuAnt::ProbeOptions(int iCell, const ValueSet& options)
+{
+	ValueSet kept = options;
+	ValueSet value = ValueSet(sol.GetNumUnits(), 1);
+	for (int i = 0; i < sol.GetNumUnits(); i++)
+	{
+		if (options.Contains(value))
+		{
+			BoardTrail::Mark mark = trail.GetMark(sol);
+			SetCellAndPropagate(sol, iCell, value);
+			if (sol.InfeasibleCellCount() > mark.infeasibleCells)
+				kept -= value;
+			trail.Undo(sol, mark);
+		}
+		value <<= 1;
+	}
+	return kept.Empty() ? options : kept;
+}
+
+// One step of the sequential order with backtracking. A backtrack moves the
+// construction back to the undone decision, so a step fills cells until the
+// construction is again as far as the number of steps taken.
+template<class Policy>
+void SudokuAnt::StepWithBacktracking()
+{
+	++steps;
+	while (pos < steps)
+	{
+		int cell = (firstCell + pos) % sol.CellCount();
+		const ValueSet& options = sol.GetCell(cell);
+		if (options.Empty() || options.Fixed())
+		{
+			FillCell<Policy>(cell);
+			++pos;
+			continue;
+		}
+		// record the decision, dropping the oldest one if the ring is full
+		if (numDecisions == backtrackDepth)
+			firstDecision = (firstDecision + 1) % backtrackDepth;
+		else
+			++numDecisions;
+		Decision& d = decisions[(firstDecision + numDecisions - 1) % backtrackDepth];
+		d.cell = cell;
+		d.pos = pos;
+		d.failCells = failCells;
+		d.options = options;
+		d.mark = trail.GetMark(sol);
+		FillCell<Policy>(cell);
+		++pos;
+		if (!sol.GetCell(cell).Fixed())
+		{
+			--numDecisions;	// the roulette made no choice
+			continue;
+		}
+		d.tried = sol.GetCell(cell);
+		if (sol.InfeasibleCellCount() > d.mark.infeasibleCells)
+			Backtrack<Policy>();
+	}
+}
+
+// The latest decision left a cell without candidates: undo decisions, newest
+// first, until one has an untried value and take the best of those by
+// pheromone. Stops at the first choice that empties no cell, or when the
+// decisions or the budget run out (the ant then carries on with the failure).
+template<class Policy>
+void SudokuAnt::Backtrack()
+{
+	while (numDecisions > 0 && backtracksLeft > 0)
+	{
+		Decision& d = decisions[(firstDecision + numDecisions - 1) % backtrackDepth];
+		ValueSet untried = d.options - d.tried;
+		if (untried.Empty())
+		{
+			--numDecisions;
+			continue;
+		}
+		--backtracksLeft;
+		trail.Undo(sol, d.mark);
+		failCells = d.failCells;
+
+		ValueSet choice = ValueSet(sol.GetNumUnits(), 1);
+		ValueSet best;
+		float maxPher = -1.0f;
+		for (int i = 0; i < sol.GetNumUnits(); i++)
+		{
+			if (untried.Contains(choice) && parent->Pher(d.cell, i) > maxPher)
+			{
+				maxPher = parent->Pher(d.cell, i);
+				best = choice;
+			}
+			choice <<= 1;
+		}
+		SetCellAndPropagate(sol, d.cell, best);
+		Policy::LocalUpdate(pher[d.cell][best.Index()], pher0);
+		d.tried += best;
+		pos = d.pos + 1;
+		if (sol.InfeasibleCellCount() == d.mark.infeasibleCells)
+			return;
+	}
+}
+
+template void SudokuAnt::StepSolution<ACSPolicy>();
+template void SudokuAnt::StepSolution<MMASPolicy>();
+template void SudokuAnt::StepSolution<IterationBestPolicy>();
@@ -1,6 +1,29 @@
 #pragma once
 #include "board.h"
 #include "antcolonyinterface.h"
+#include "cellbuckets.h"
+#include "boardtrail.h"
+#include "failureheatmap.h"
+#include <vector>
+#include <string>
+
+// Order in which an ant visits the cells
+enum AntOrdering
+{
+	ORDER_SEQUENTIAL,		// from a random start cell, wrapping around
+	ORDER_MOST_CONSTRAINED,	// fewest remaining candidates first, random tie-breaking
+	ORDER_HEAT				// hot cells of the failure heatmap first, hottest first, then sequential
+};
+
+// Parse an --antorder value (seq, mcf or heat)
+inline AntOrdering ParseAntOrdering(const std::string& name)
+{
+	if (name == "mcf")
+		return ORDER_MOST_CONSTRAINED;
+	if (name == "heat")
+		return ORDER_HEAT;
+	return ORDER_SEQUENTIAL;
+}
 
 class SudokuAnt
 {
@@ -10,11 +33,68 @@ class SudokuAnt
 	int failCells;	// no of cells on this attempt which were unsettable
 	float *roulette; // working array for the roulette wheel selection
 	ValueSet *rouletteVals; // working array for the roulette wheel selection
+	int rouletteSize;	// allocated length of roulette and rouletteVals
+	AntOrdering ordering;
+	CellBuckets buckets;	// unvisited cells by candidate count (ORDER_MOST_CONSTRAINED)
+	const FailureHeatmap *heatmap;	// colony's heatmap (ORDER_HEAT)
+	int hotPos;				// hot cells visited so far (ORDER_HEAT)
+
+	// bounded local backtracking (SetBacktracking)
+	struct Decision
+	{
+		int cell;
+		int pos;				// step of the construction that filled the cell
+		int failCells;			// failCells before that step
+		ValueSet options;		// candidates of the cell before the choice
+		ValueSet tried;			// values tried so far
+		BoardTrail::Mark mark;	// board before the choice
+	};
+	int backtrackDepth;		// decisions that can be undone (0 = off)
+	int backtrackBudget;	// undos per construction
+	int backtracksLeft;
+	int firstCell;			// start cell of the construction
+	int steps;				// StepSolution calls since InitSolution
+	int pos;				// steps of the construction completed
+	std::vector<Decision> decisions;	// ring of the last backtrackDepth decisions
+	int firstDecision;
+	int numDecisions;
+	BoardTrail trail;		// undo log of sol
+	int probeCandidates;	// probe cells with at most this many candidates (0 = off)
+	float **pher;			// parent's pheromone matrix (set by InitSolution)
+	float pher0;
+
+	int NextCell();
+	int NextHeatCell();
+	template<class Policy> void FillCell(int iCell);
+	template<class Policy> void StepWithBacktracking();
+	template<class Policy> void Backtrack();
+	ValueSet ProbeOptions(int iCell, const ValueSet& options);
 
 public:	
-	SudokuAnt(IAntColony *parent) : parent(parent), iCell(0), roulette(nullptr), rouletteVals(nullptr) {}
+	SudokuAnt(IAntColony *parent, AntOrdering ordering = ORDER_SEQUENTIAL) : 
+		parent(parent), iCell(0), roulette(nullptr), rouletteVals(nullptr), rouletteSize(0), ordering(ordering),
+		heatmap(nullptr), hotPos(0),
+		backtrackDepth(0), backtrackBudget(0), backtracksLeft(0), firstCell(0), steps(0), pos(0),
+		firstDecision(0), numDecisions(0), probeCandidates(0), pher(nullptr), pher0(0.0f) {}
+	~SudokuAnt();
+	// size the working arrays for puzzles of up to numUnits values (grow only)
+	void Reset(int numUnits);
+	void SetOrdering(AntOrdering o) { ordering = o; }
+	// heatmap the heat order reads (must be enabled for ORDER_HEAT)
+	void SetHeatmap(const FailureHeatmap *h) { heatmap = h; }
+	// On a choice that leaves a cell without candidates, undo up to depth of
+	// the latest decisions (newest first) and take the best untried value by
+	// pheromone, at most budget times per construction. depth 0 = off.
+	// Sequential order only; the most-constrained order ignores it.
+	void SetBacktracking(int depth, int budget) { backtrackDepth = depth; backtrackBudget = budget; }
+	// Before choosing a value for a cell with at most maxCandidates
+	// candidates, try each one and leave out those whose propagation empties
+	// a cell (unless all do). 0 = off. Sequential order only.
+	void SetProbing(int maxCandidates) { probeCandidates = maxCandidates; }
 	void InitSolution(const Board &puzzle, int ic);
-	void StepSolution();
+	// one step of the construction; Policy supplies the local pheromone
+	// update (instantiated for the policies of pheromonepolicy.h)
+	template<class Policy> void StepSolution();
 	const Board& GetSolution() { return sol; }
 	int NumCellsFilled() { return sol.CellCount() - failCells; }
 };
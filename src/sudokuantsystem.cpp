@@ -21,21 +21,130 @@
 // ============================================================================
 
 /*******************************************************************************
- * InitPheromone - Allocate and initialize the pheromone matrix
+ * Reset - Size the solver's buffers for puzzles of the given order
  * 
- * Creates a 2D pheromone matrix:
+ * The pheromone matrix and the ants' working arrays only grow: after a Reset
+ * (or a first solve) of order n, solving any puzzle of order up to n allocates
+ * nothing per iteration. Start() calls this for the puzzle's order.
+ ******************************************************************************/
+void SudokuAntSystem::Reset(int order)
+{
+	int units = order * order;
+	int cells = units * units;
+	if (cells > pherCells || units > pherUnits)
+	{
+		ClearPheromone();
+		pher = new float*[cells];
+		for (int i = 0; i < cells; i++)
+			pher[i] = new float[units];
+		pherCells = cells;
+		pherUnits = units;
+	}
+	for (auto a : antList)
+		a->Reset(units);
+	if (antEngine != ANT_ENGINE_SCALAR)
+	{
+		population.Reset(numAnts, order, antEngine);
+		if ((int)startCells.size() < numAnts)
+			startCells.resize(numAnts);
+	}
+}
+
+/*******************************************************************************
+ * ConstructSolutions - One construction pass of all ants
+ *
+ * The start cells are drawn in ant order by both engines, so a seeded run
+ * gives the same solutions with either engine. Only the first
+ * antCount.Active() ants run. Policy supplies the ants' local pheromone
+ * update.
+ ******************************************************************************/
+template<class Policy>
+void SudokuAntSystem::ConstructSolutions(const Board& puzzle)
+{
+	// Start each ant on a random cell (drawn from the heatmap, if biased)
+	std::uniform_int_distribution<int> dist(0, puzzle.CellCount()-1);
+	int active = antCount.Active();
+	if (antEngine != ANT_ENGINE_SCALAR)
+	{
+		for (int i = 0; i < active; i++)
+			startCells[i] = heatmap.DrawStartCell(randGen, dist, randomDist);
+		population.SetActive(active);
+		population.Construct<Policy>(puzzle, startCells.data());
+		return;
+	}
+	for (int i = 0; i < active; i++)
+	{
+		antList[i]->InitSolution(puzzle, heatmap.DrawStartCell(randGen, dist, randomDist));
+	}
+	
+	// Fill cells one at a time (all ants step in parallel)
+	for (int i = 0; i < puzzle.CellCount(); i++)
+	{
+		for (int j = 0; j < active; j++)
+		{
+			antList[j]->StepSolution<Policy>();
+		}
+	}
+}
+
+/*******************************************************************************
+ * RecordFailures - Add the cells the ants left empty to the heatmap
+ ******************************************************************************/
+void SudokuAntSystem::RecordFailures()
+{
+	heatmap.Decay();
+	int active = antCount.Active();
+	float weight = 1.0f / active;
+	for (int i = 0; i < active; i++)
+	{
+		if (NumCellsFilled(i) == numCells)
+			continue;
+		for (int c = 0; c < numCells; c++)
+		{
+			bool empty = (antEngine != ANT_ENGINE_SCALAR) ? population.CellEmpty(i, c)
+				: antList[i]->GetSolution().GetCell(c).Empty();
+			if (empty)
+				heatmap.AddFailure(c, weight);
+		}
+	}
+	heatmap.Commit();
+}
+
+int SudokuAntSystem::NumCellsFilled(int iAnt)
+{
+	if (antEngine != ANT_ENGINE_SCALAR)
+		return population.NumCellsFilled(iAnt);
+	return antList[iAnt]->NumCellsFilled();
+}
+
+// Solution of ant iAnt (exported into populationBest for the population engine)
+const Board& SudokuAntSystem::AntSolution(int iAnt, const Board& puzzle)
+{
+	if (antEngine != ANT_ENGINE_SCALAR)
+	{
+		population.ExportSolution(iAnt, puzzle, populationBest);
+		return populationBest;
+	}
+	return antList[iAnt]->GetSolution();
+}
+
+/*******************************************************************************
+ * InitPheromone - Initialize the pheromone matrix
+ * 
+ * Uses the first numCells rows and valuesPerCell columns of the matrix
+ * allocated by Reset():
  * - Rows: cells in the puzzle (numCells)
  * - Columns: possible values for each cell (valuesPerCell)
  * 
- * All pheromone values are initialized uniformly to pher0.
+ * All pheromone values are initialized uniformly to pher0; Start() then
+ * applies the prior, if any (see ApplyPheromonePrior).
  ******************************************************************************/
 void SudokuAntSystem::InitPheromone(int numCells, int valuesPerCell )
 {
 	this->numCells = numCells;
-	pher = new float*[numCells];
+	this->numUnits = valuesPerCell;
 	for (int i = 0; i < numCells; i++)
 	{
-		pher[i] = new float[valuesPerCell];
 		for (int j = 0; j < valuesPerCell; j++)
 			pher[i][j] = pher0;
 	}
@@ -44,13 +153,18 @@ void SudokuAntSystem::InitPheromone(int numCells, int valuesPerCell )
 /*******************************************************************************
  * ClearPheromone - Deallocate the pheromone matrix
  * 
- * Called at the end of solving to clean up memory.
+ * Called when the matrix has to grow and by the destructor.
  ******************************************************************************/
 void SudokuAntSystem::ClearPheromone()
 {
-	for (int i = 0; i < numCells; i++)
+	if (pher == nullptr)
+		return;
+	for (int i = 0; i < pherCells; i++)
 		delete[] pher[i];
 	delete[] pher;
+	pher = nullptr;
+	pherCells = 0;
+	pherUnits = 0;
 }
 
 // ============================================================================
@@ -58,66 +172,116 @@ void SudokuAntSystem::ClearPheromone()
 // ============================================================================
 
 /*******************************************************************************
- * Solve - Main algorithm loop for single-threaded ACS
+ * Start - Prepare a solve that is then run in slices by Step()
  * 
- * Algorithm flow:
- * 1. Initialize pheromone matrix
- * 2. Loop until solution found or timeout:
- *    a. Each ant constructs a solution (probabilistic + greedy choice)
- *    b. Find iteration-best ant
- *    c. Update best-so-far if improved
- *    d. Apply global pheromone update (reinforce best-so-far)
- *    e. Decay best pheromone value
- * 3. Return success/failure
+ * Copies the puzzle (it need not outlive the call) and initializes the
+ * pheromone matrix, reusing the buffers of earlier solves.
  * 
  * Parameters:
  *   puzzle   - The initial puzzle (after constraint propagation)
- *   maxTime  - Time limit in seconds
- * 
- * Returns: true if a complete solution was found
+ *   maxTime  - Time limit in seconds, counting only the time inside Step()
  ******************************************************************************/
-bool SudokuAntSystem::Solve(const Board& puzzle, float maxTime )
+void SudokuAntSystem::Start(const Board& puzzle, float maxTime )
 {
 	solutionTimer.Reset();
-	int iter = 0;
-	bool solved = false;
+	stepPuzzle.Copy(puzzle);
+	stepMaxTime = maxTime;
+	solved = false;
+	timedOut = false;
 	bestPher = 0.0f;
 	iterationsCompleted = 0;
+	bestSolScore = 0;
+	bestChanged = false;
+	if (finisher != nullptr)
+		finisher->Reset();
+	stagnation.Reset(puzzle.FixedCellCount());
+	heatmap.Reset(puzzle.CellCount());
+	antCount.Reset(numAnts, puzzle.FixedCellCount());
+	if (seeded)
+	{
+		uint64_t state = seed;
+		randGen.seed((uint32_t)SplitMix64(state));
+		randomDist.reset();
+	}
+	iterationLimit = IterationLimit(maxIterations, maxAntSteps, (long long)numAnts * puzzle.CellCount());
+
+	// the update rules are fixed for the whole solve (see pheromonepolicy.h)
+	switch (variant)
+	{
+	case VARIANT_MMAS:
+		stepVariant = &SudokuAntSystem::StepT<MMASPolicy>;
+		break;
+	case VARIANT_ITERATION_BEST:
+		stepVariant = &SudokuAntSystem::StepT<IterationBestPolicy>;
+		break;
+	case VARIANT_ACS:
+	default:
+		stepVariant = &SudokuAntSystem::StepT<ACSPolicy>;
+		break;
+	}
 	
 	// Initialize pheromone matrix
+	Reset( puzzle.GetOrder() );
 	InitPheromone( puzzle.CellCount(), puzzle.GetNumUnits() );
+	ApplyPheromonePrior( pher, puzzle, pher0, prior );
+}
+
+/*******************************************************************************
+ * Step - Run up to budget iterations of the single-threaded ACS
+ * 
+ * Algorithm flow of one iteration:
+ *    a. Each ant constructs a solution (probabilistic + greedy choice)
+ *    b. Find iteration-best ant
+ *    c. Update best-so-far if improved
+ *    d. Apply global pheromone update (reinforce best-so-far)
+ *    e. Decay best pheromone value
+ * 
+ * With stagnation detection (SetStagnation) the pheromone is reset before
+ * step d once the colony has stopped improving. With adaptive ants
+ * (SetAdaptiveAnts) step b also sets the ant count of the next iteration.
+ * The solve fails when the time limit or the iteration budget is used up.
+ * If the exact finisher is enabled it is launched on the best-so-far solution
+ * whenever that is within finisherGap cells of complete, and the loop stops
+ * as soon as the finisher reports a solution.
+ * 
+ * The iterations run in StepT, instantiated per pheromone policy; Start
+ * picks the instantiation of the configured variant.
+ * 
+ * Returns: progress, with state SOLVE_RUNNING while more iterations are needed
+ ******************************************************************************/
+SolveProgress SudokuAntSystem::Step(int budget)
+{
+	return (this->*stepVariant)(budget);
+}
+
+template<class Policy>
+SolveProgress SudokuAntSystem::StepT(int budget)
+{
+	const Board& puzzle = stepPuzzle;
+	solutionTimer.Resume();
+	int startIter = iterationsCompleted;
 	
-	// Main iteration loop
-	while (!solved)
+	while (!solved && !timedOut && iterationsCompleted - startIter < budget)
 	{
 		// === ANT CONSTRUCTION PHASE ===
-		// Start each ant on a random cell
-		std::uniform_int_distribution<int> dist(0, puzzle.CellCount()-1);
-		for (auto a : antList)
-		{
-			a->InitSolution(puzzle, dist(randGen));
-		}
-		
-		// Fill cells one at a time (all ants step in parallel)
-		for (int i = 0; i < puzzle.CellCount(); i++)
-		{
-			for (auto a : antList)
-			{
-				a->StepSolution();
-			}
-		}
+		iterationTimer.Reset();
+		ConstructSolutions<Policy>(puzzle);
+		if (heatmap.Enabled())
+			RecordFailures();
 		
 		// === FIND ITERATION-BEST ANT ===
 		int iBest = 0;
 		int bestVal = 0;
-		for (unsigned int i = 0; i < antList.size(); i++)
+		for (int i = 0; i < antCount.Active(); i++)
 		{
-			if (antList[i]->NumCellsFilled() > bestVal)
+			if (NumCellsFilled(i) > bestVal)
 			{
-				bestVal = antList[i]->NumCellsFilled();
+				bestVal = NumCellsFilled(i);
 				iBest = i;
 			}
 		}
+		const Board& iterationBest = AntSolution(iBest, puzzle);
+		antCount.Update(bestVal, iterationTimer.Elapsed());
 		
 		// Calculate pheromone reinforcement value
 		float pherToAdd = PherAdd(bestVal);
@@ -125,8 +289,10 @@ bool SudokuAntSystem::Solve(const Board& puzzle, float maxTime )
 		// === UPDATE BEST-SO-FAR SOLUTION ===
 		if (pherToAdd > bestPher)
 		{
-			bestSol.Copy(antList[iBest]->GetSolution());
+			bestSol.Copy(iterationBest);
 			bestPher = pherToAdd;
+			bestSolScore = bestVal;
+			bestChanged = true;
 			
 			// Check if complete solution found
 			if (bestVal == numCells)
@@ -136,66 +302,118 @@ bool SudokuAntSystem::Solve(const Board& puzzle, float maxTime )
 			}
 		}
 		
-		// === PHEROMONE UPDATE ===
-		UpdatePheromone();           // Global update (reinforce best-so-far)
-		bestPher *= (1.0f - bestEvap); // Decay best pheromone value
-		
-		++iter;
-		
-		// === TIMEOUT CHECK (every 100 iterations) ===
-		if ((iter % 100) == 0)
+		// === EXACT FINISHER ===
+		if (finisher != nullptr && !solved)
 		{
-			float elapsed = solutionTimer.Elapsed();
-			if ( elapsed > maxTime)
+			if (finisher->Succeeded())
+			{
+				bestSol.Copy(finisher->GetSolution());
+				bestSolScore = numCells;
+				solved = true;
+				solTime = solutionTimer.Elapsed();
+			}
+			else if (bestChanged && numCells - bestSolScore <= finisherGap)
 			{
-				break;
+				if (finisher->Launch(puzzle, bestSol))
+					bestChanged = false;
 			}
 		}
+		
+		// === STAGNATION RESTART ===
+		// Before the global update, so the best-so-far is reinforced again at once
+		if (stagnation.Update(bestVal, pher, numCells, numUnits))
+			stagnation.Restart(pher, numCells, numUnits, pher0, bestSol, iterationBest);
+		
+		// === PHEROMONE UPDATE ===
+		// Global update (reinforce best-so-far) and decay of the best pheromone value
+		UpdatePheromoneT<Policy>(iterationBest, bestVal);
+		
+		++iterationsCompleted;
+		
+		// === TIMEOUT CHECK (every 100 iterations) ===
+		if ((iterationsCompleted % 100) == 0 && solutionTimer.Elapsed() > stepMaxTime)
+			timedOut = true;
+		
+		// === ITERATION BUDGET ===
+		if (iterationLimit > 0 && iterationsCompleted >= iterationLimit)
+			timedOut = true;
 	}
+	// the slice may end between the periodic checks
+	if (!solved && solutionTimer.Elapsed() > stepMaxTime)
+		timedOut = true;
+	solutionTimer.Pause();
 	
-	iterationsCompleted = iter;
-	ClearPheromone();
-	return solved;
+	SolveProgress progress;
+	progress.state = solved ? SOLVE_SOLVED : (timedOut ? SOLVE_FAILED : SOLVE_RUNNING);
+	progress.steps = iterationsCompleted - startIter;
+	progress.totalSteps = iterationsCompleted;
+	progress.bestScore = bestSolScore;
+	progress.elapsed = solutionTimer.Elapsed();
+	return progress;
 }
 
-// ============================================================================
-// SECTION 3: PHEROMONE MANAGEMENT
-// ============================================================================
+/*******************************************************************************
+ * Finish - End a solve started by Start()
+ * 
+ * The buffers are kept for the next solve (see Reset).
+ * 
+ * Returns: true if a complete solution was found
+ ******************************************************************************/
+bool SudokuAntSystem::Finish()
+{
+	if (!solved)
+		solTime = solutionTimer.Elapsed();
+	if (finisher != nullptr)
+		finisher->Stop();
+	return solved;
+}
 
 /*******************************************************************************
- * UpdatePheromone - Global pheromone update (ACS rule)
+ * Solve - Main algorithm loop for single-threaded ACS
  * 
- * Reinforces the best-so-far solution by updating pheromone on its path:
- *   τ(i,j) ← (1-ρ)·τ(i,j) + ρ·bestPher
+ * Runs Start/Step/Finish until a solution is found or the time limit is
+ * reached, checking the time every 100 iterations.
+ * 
+ * Parameters:
+ *   puzzle   - The initial puzzle (after constraint propagation)
+ *   maxTime  - Time limit in seconds
  * 
- * Only cells in the best-so-far solution receive reinforcement.
- * This is the standard ACS global update rule.
+ * Returns: true if a complete solution was found
  ******************************************************************************/
-void SudokuAntSystem::UpdatePheromone()
+bool SudokuAntSystem::Solve(const Board& puzzle, float maxTime )
 {
-	for (int i = 0; i < numCells; i++)
-	{
-		if (bestSol.GetCell(i).Fixed())
-		{
-			pher[i][bestSol.GetCell(i).Index()] = pher[i][bestSol.GetCell(i).Index()] * (1.0f - rho) + rho * bestPher;
-		}
-	}
+	Start(puzzle, maxTime);
+	while (Step(100).state == SOLVE_RUNNING)
+		;
+	return Finish();
 }
 
+// ============================================================================
+// SECTION 3: PHEROMONE MANAGEMENT
+// ============================================================================
+
 /*******************************************************************************
- * LocalPheromoneUpdate - Local pheromone update (ACS rule)
+ * UpdatePheromoneT - Global pheromone update
  * 
- * Called during ant construction to slightly decrease pheromone on visited
- * edges, encouraging exploration:
- *   τ(i,j) ← 0.9·τ(i,j) + 0.1·τ₀
+ * Applies the update rules of Policy (see pheromonepolicy.h). For the default
+ * ACS policy this reinforces the best-so-far solution:
+ *   τ(i,j) ← (1-ρ)·τ(i,j) + ρ·bestPher
+ * and then decays bestPher by bestEvap. The local update of the ants,
+ * τ(i,j) ← 0.9·τ(i,j) + 0.1·τ₀ for ACS, is applied by the ants themselves
+ * through the same policy.
  * 
  * Parameters:
- *   iCell   - The cell being filled
- *   iChoice - The value chosen for the cell
+ *   iterationBest      - The best ant solution of this iteration
+ *   iterationBestScore - Number of cells filled in iterationBest
  ******************************************************************************/
-void SudokuAntSystem::LocalPheromoneUpdate(int iCell, int iChoice)
+template<class Policy>
+void SudokuAntSystem::UpdatePheromoneT(const Board& iterationBest, int iterationBestScore)
 {
-	pher[iCell][iChoice] = pher[iCell][iChoice] * 0.9f + pher0 * 0.1f;
+	if (Policy::useIterationBest)
+		GlobalPheromoneUpdate<Policy>(pher, numCells, numUnits, iterationBest, rho, PherAdd(iterationBestScore));
+	else
+		GlobalPheromoneUpdate<Policy>(pher, numCells, numUnits, bestSol, rho, bestPher);
+	Policy::EvaporateBest(bestPher, bestEvap);
 }
 
 /*******************************************************************************
@@ -205,6 +423,7 @@ void SudokuAntSystem::LocalPheromoneUpdate(int iCell, int iChoice)
  *   pheromone = numCells / (numCells - numCellsFixed)
  * 
  * Better solutions (more cells filled) receive higher pheromone values.
+ * All variants share this measure, so it is also used to rank solutions.
  * 
  * Parameters:
  *   numCellsFixed - Number of cells filled in the solution
@@ -213,5 +432,21 @@ void SudokuAntSystem::LocalPheromoneUpdate(int iCell, int iChoice)
  ******************************************************************************/
 float SudokuAntSystem::PherAdd(int numCellsFixed)
 {
-	return numCells / (float)(numCells - numCellsFixed);
+	return ACSPolicy::Deposit(numCells, numCellsFixed);
+}
+
+/*******************************************************************************
+ * SetFinisher - Enable the exact finishing stage
+ * 
+ * Parameters:
+ *   gap       - Launch when the best-so-far is at most gap cells short
+ *   maxTime   - Time limit for each finishing attempt
+ *   stepLimit - Backtracking step limit for each attempt (0 = none)
+ ******************************************************************************/
+void SudokuAntSystem::SetFinisher(int gap, float maxTime, int stepLimit)
+{
+	if (finisher != nullptr)
+		delete finisher;
+	finisher = (gap > 0) ? new ExactFinisher(maxTime, stepLimit) : nullptr;
+	finisherGap = gap;
 }
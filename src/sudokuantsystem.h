@@ -6,6 +6,12 @@
 #include "board.h"
 #include "timer.h"
 #include "sudokusolver.h"
+#include "exactfinisher.h"
+#include "pheromonepolicy.h"
+#include "antpopulation.h"
+#include "stagnation.h"
+#include "failureheatmap.h"
+#include "antcount.h"
 
 class SudokuAntSystem : public SudokuSolver, public IAntColony
 {
@@ -17,26 +23,69 @@ class SudokuAntSystem : public SudokuSolver, public IAntColony
 	Board bestSol;
 	float bestPher;
 	int iterationsCompleted;
-	Timer solutionTimer;
+	SliceTimer solutionTimer;	// time spent inside Step()
 	float solTime;
 
+	// state of the resumable solve (Start/Step/Finish)
+	Board stepPuzzle;
+	float stepMaxTime;
+	bool solved;
+	bool timedOut;	// time limit or iteration budget used up
+	int bestSolScore;
+	bool bestChanged;	// best-so-far changed since the last finisher launch
+
+	// reproducible runs (SetSeed) and work budgets (SetBudget)
+	bool seeded;
+	uint64_t seed;
+	int maxIterations;			// 0 = no limit
+	long long maxAntSteps;		// 0 = no limit
+	int iterationLimit;			// limit for the current solve (0 = none)
+
+	ExactFinisher *finisher;	// optional exact finishing stage (nullptr = off)
+	int finisherGap;			// launch the finisher when best is within this many cells
+	StagnationDetector stagnation;	// pheromone restarts (off by default)
+	FailureHeatmap heatmap;		// where the ants fail (off by default)
+	AntCountController antCount;	// ants run per iteration (all of them by default)
+	Timer iterationTimer;
+
 	std::vector<SudokuAnt*> antList;
+	AntEngine antEngine;		// construction engine (see antpopulation.h)
+	AntPopulation population;	// ants of the population engine
+	std::vector<int> startCells;	// start cells of the population engine's ants
+	Board populationBest;		// iteration-best solution exported from population
 	std::mt19937 randGen; 
 	std::uniform_real_distribution<float> randomDist;
 
 	float **pher; // pheromone matrix
+	int pherCells;	// allocated rows of pher
+	int pherUnits;	// allocated columns of pher
 	int numCells;
+	int numUnits;
+	PheromoneVariant variant;	// pheromone update rules (see pheromonepolicy.h)
+	PheromonePrior prior;		// initial pheromone (see pheromonepolicy.h)
+	SolveProgress (SudokuAntSystem::*stepVariant)(int budget);	// StepT of the variant, chosen by Start
 	void InitPheromone(int numCells, int valuesPerCell);
 	void ClearPheromone();
-	void UpdatePheromone();
+	template<class Policy> void UpdatePheromoneT(const Board& iterationBest, int iterationBestScore);
 	float PherAdd(int numCellsFixed);
+	template<class Policy> void ConstructSolutions(const Board& puzzle);
+	template<class Policy> SolveProgress StepT(int budget);
+	void RecordFailures();
+	int NumCellsFilled(int iAnt);
+	const Board& AntSolution(int iAnt, const Board& puzzle);
 
 public:
 	SudokuAntSystem(int numAnts, float q0, float rho, float pher0, float bestEvap) : 
-		numAnts(numAnts), q0(q0), rho(rho), pher0(pher0), bestEvap(bestEvap), iterationsCompleted(0)
+		numAnts(numAnts), q0(q0), rho(rho), pher0(pher0), bestEvap(bestEvap), iterationsCompleted(0),
+		solTime(0.0f), stepMaxTime(0.0f), solved(false), timedOut(false), bestSolScore(0), bestChanged(false),
+		seeded(false), seed(0), maxIterations(0), maxAntSteps(0), iterationLimit(0),
+		finisher(nullptr), finisherGap(0), antEngine(ANT_ENGINE_SCALAR), population(this), pher(nullptr), pherCells(0), pherUnits(0), numCells(0), numUnits(0), variant(VARIANT_ACS), prior(PRIOR_NONE), stepVariant(nullptr)
 	{
 		for ( int i = 0; i < numAnts; i++ )
+		{
 			antList.push_back(new SudokuAnt(this));
+			antList.back()->SetHeatmap(&heatmap);
+		}
 		randomDist = std::uniform_real_distribution<float>(0.0f, 1.0f);
 		std::random_device rd;
 		randGen = std::mt19937(rd());
@@ -45,8 +94,53 @@ public:
 	{
 		for (auto a : antList)
 			delete a;
+		if (finisher != nullptr)
+			delete finisher;
+		ClearPheromone();
+	}
+	// enable the exact finisher for best solutions within gap cells of complete
+	void SetFinisher(int gap, float maxTime, int stepLimit);
+	void SetVariant(PheromoneVariant v) { variant = v; }
+	void SetPrior(PheromonePrior p) { prior = p; }
+	// restart the pheromone after window iterations without improvement (0 = off)
+	void SetStagnation(int window, float concentration, RestartAction action) { stagnation.Configure(window, concentration, action); }
+	int GetRestarts() const { return stagnation.Restarts(); }
+	// decaying per-cell failure counts, optionally biasing the start cells (see failureheatmap.h)
+	void SetHeatmap(bool on, float decay, float startBias) { heatmap.Configure(on, decay, startBias); }
+	const FailureHeatmap& GetHeatmap() const { return heatmap; }
+	// adapt the ants run per iteration between minAnts and numAnts (0 = off, see antcount.h)
+	void SetAdaptiveAnts(int minAnts, float maxIterationTime) { antCount.Configure(minAnts, maxIterationTime); }
+	float GetMeanAnts() const { return antCount.MeanAnts(); }
+	// keep buffers for puzzles of up to this order (grow only)
+	void Reset(int order);
+	// reseed the random generator with seed at the start of every solve
+	void SetSeed(uint64_t s) { seeded = true; seed = s; }
+	// stop after maxIterations iterations or maxAntSteps ant steps (0 = no limit)
+	void SetBudget(int iterations, long long antSteps) { maxIterations = iterations; maxAntSteps = antSteps; }
+	void SetAntOrdering(AntOrdering o)
+	{
+		for (auto a : antList)
+			a->SetOrdering(o);
+	}
+	// bounded local backtracking of the scalar ants (see SudokuAnt::SetBacktracking)
+	void SetAntBacktracking(int depth, int budget)
+	{
+		for (auto a : antList)
+			a->SetBacktracking(depth, budget);
+	}
+	// one-step probing of the scalar ants (see SudokuAnt::SetProbing)
+	void SetAntProbing(int maxCandidates)
+	{
+		for (auto a : antList)
+			a->SetProbing(maxCandidates);
 	}
+	// construction engine; the population engine uses the sequential cell order
+	void SetAntEngine(AntEngine e) { antEngine = e; }
 	virtual bool Solve(const Board& puzzle, float maxTime );
+	// resumable interface; a work unit is one colony iteration
+	virtual void Start(const Board& puzzle, float maxTime );
+	virtual SolveProgress Step(int budget);
+	virtual bool Finish();
 	virtual float GetSolutionTime() { return solTime; }
 	virtual const Board& GetSolution() { return bestSol; }
 	int GetIterationsCompleted() { return iterationsCompleted; }
@@ -54,5 +148,6 @@ public:
 	inline float Getq0() { return q0; }
 	inline float random() { return randomDist(randGen); }
 	inline float Pher(int i, int j) { return pher[i][j]; }
-	void LocalPheromoneUpdate(int iCell, int iChoice);
+	float **PherMatrix() { return pher; }
+	float Pher0() { return pher0; }
 };
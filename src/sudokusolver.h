@@ -1,11 +1,65 @@
 #pragma once
 #include "board.h"
+#include <cstdint>
+
+// state of a resumable solve (see SudokuSolver::Step)
+enum SolveState
+{
+	SOLVE_RUNNING,	// more steps needed
+	SOLVE_SOLVED,	// complete solution found
+	SOLVE_FAILED	// time limit reached or search space exhausted
+};
+
+// progress report of a resumable solve
+struct SolveProgress
+{
+	SolveState state;
+	int steps;		// work units done by this Step() call
+	int totalSteps;	// work units done since Start()
+	int bestScore;	// fixed cells in the best solution so far
+	float elapsed;	// time spent inside Step() since Start()
+};
+
+// SplitMix64 step: derives a sequence of well-mixed seeds from one master seed
+inline uint64_t SplitMix64(uint64_t &state)
+{
+	uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+// Iteration limit from an iteration budget and an ant-step budget (0 = none);
+// antStepsPerIteration is the number of ant steps one iteration takes
+inline int IterationLimit(int maxIterations, long long maxAntSteps, long long antStepsPerIteration)
+{
+	long long limit = maxIterations;
+	if (maxAntSteps > 0)
+	{
+		long long fromSteps = (maxAntSteps + antStepsPerIteration - 1) / antStepsPerIteration;
+		if (limit == 0 || fromSteps < limit)
+			limit = fromSteps;
+	}
+	return (int)limit;
+}
 
 // pure virtual interface shared between backtrack search and sudoku ant system
+//
+// Besides the blocking Solve() every solver can be driven in slices:
+// Start() prepares a solve, each Step(budget) does at most budget work units
+// and returns, and Finish() releases the working state and returns success.
+// The time limit given to Start() counts only the time spent inside Step(),
+// so one thread can interleave many solves fairly. Work units are ant colony
+// iterations for the ant systems and search nodes for backtracking.
 class SudokuSolver
 {
 public:
+	virtual ~SudokuSolver() {}
 	virtual bool Solve(const Board& puzzle, float maxTime) = 0;
 	virtual float GetSolutionTime() = 0;
 	virtual const Board& GetSolution() = 0;
+
+	virtual void Start(const Board& puzzle, float maxTime) = 0;
+	virtual SolveProgress Step(int budget) = 0;
+	virtual bool Finish() = 0;
 };
@@ -48,3 +48,34 @@ public:
 		return (float)elapsed * inverseTimerFreq;
 	}
 };
+
+// Accumulates the time spent between Resume() and Pause() calls, so that a
+// solve run in slices is charged only for the slices themselves
+class SliceTimer
+{
+	Timer timer;
+	float total;
+	bool running;
+public:
+	SliceTimer() : total(0.0f), running(false) {}
+	void Reset()
+	{
+		total = 0.0f;
+		running = false;
+	}
+	void Resume()
+	{
+		timer.Reset();
+		running = true;
+	}
+	void Pause()
+	{
+		if (running)
+			total += timer.Elapsed();
+		running = false;
+	}
+	float Elapsed()
+	{
+		return running ? total + timer.Elapsed() : total;
+	}
+};
@@ -0,0 +1,249 @@
+/*******************************************************************************
+ * PARAMETER TUNER - Implementation
+ ******************************************************************************/
+
+#include "tuner.h"
+#include "sudokuantsystem.h"
+#include "parallelsudokuantsystem.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <thread>
+
+// significance level of the Friedman and post-hoc tests is 0.05
+static const double Z_ONE_SIDED = 1.6449;	// normal quantile 0.95
+static const double Z_TWO_SIDED = 1.9600;	// normal quantile 0.975
+
+// chi-square quantile (Wilson-Hilferty approximation)
+static double ChiSquareQuantile(int df)
+{
+	double h = 2.0 / (9.0 * df);
+	double x = 1.0 - h + Z_ONE_SIDED * sqrt(h);
+	return df * x * x * x;
+}
+
+// Student t quantile (Cornish-Fisher expansion around the normal quantile)
+static double StudentTQuantile(int df)
+{
+	double z = Z_TWO_SIDED;
+	return z + (z*z*z + z) / (4.0 * df) + (5*pow(z, 5) + 16*z*z*z + 3*z) / (96.0 * df * df);
+}
+
+ParameterRace::ParameterRace(const TunerSettings& settings) : settings(settings), randGen(settings.seed)
+{
+}
+
+/*******************************************************************************
+ * SampleConfigurations - The defaults plus uniformly sampled candidates
+ *
+ * evap is sampled on a log scale since its useful range spans two decades.
+ ******************************************************************************/
+vector<TunedParameters> ParameterRace::SampleConfigurations()
+{
+	vector<TunedParameters> configs;
+	TunedParameters defaults = { 0.9f, 0.9f, 0.005f, 10, 4 };
+	configs.push_back(defaults);
+
+	std::uniform_real_distribution<float> q0Dist(0.5f, 0.99f);
+	std::uniform_real_distribution<float> rhoDist(0.1f, 0.99f);
+	std::uniform_real_distribution<float> logEvapDist(log(0.0005f), log(0.05f));
+	std::uniform_int_distribution<int> antsDist(3, 30);
+	std::uniform_int_distribution<int> coloniesDist(2, 8);
+	while ((int)configs.size() < settings.numConfigs)
+	{
+		TunedParameters p;
+		p.q0 = q0Dist(randGen);
+		p.rho = rhoDist(randGen);
+		p.evap = exp(logEvapDist(randGen));
+		p.ants = antsDist(randGen);
+		p.subcolonies = (settings.alg == 2) ? coloniesDist(randGen) : defaults.subcolonies;
+		configs.push_back(p);
+	}
+	return configs;
+}
+
+// Cost of one run: solution time, or twice the timeout on failure (PAR2)
+float ParameterRace::RunTrial(const TunedParameters& p, const Board& puzzle)
+{
+	SudokuSolver *solver;
+	if (settings.alg == 2)
+		solver = new ParallelSudokuAntSystem(p.subcolonies, p.ants, p.q0, p.rho, 1.0f / puzzle.CellCount(), p.evap);
+	else
+		solver = new SudokuAntSystem(p.ants, p.q0, p.rho, 1.0f / puzzle.CellCount(), p.evap);
+	bool success = solver->Solve(puzzle, settings.trialTimeout);
+	float cost = (success && puzzle.CheckSolution(solver->GetSolution())) ? solver->GetSolutionTime() : 2.0f * settings.trialTimeout;
+	delete solver;
+	return cost;
+}
+
+// Run every surviving configuration on puzzle, settings.threads at a time
+void ParameterRace::RunBlock(const vector<TunedParameters>& configs, const vector<int>& alive, const Board& puzzle, vector<float>& costs)
+{
+	costs.assign(alive.size(), 0.0f);
+	std::atomic<int> next(0);
+	auto worker = [&]()
+	{
+		int k;
+		while ((k = next.fetch_add(1)) < (int)alive.size())
+			costs[k] = RunTrial(configs[alive[k]], puzzle);
+	};
+	int numThreads = std::max(1, std::min(settings.threads, (int)alive.size()));
+	vector<std::thread> threads;
+	for (int t = 0; t < numThreads; t++)
+		threads.emplace_back(worker);
+	for (auto& t : threads)
+		t.join();
+}
+
+// Ranks 1..m of the costs within a block, ties get the average rank
+void ParameterRace::RankBlock(const vector<float>& costs, vector<float>& ranks)
+{
+	int m = (int)costs.size();
+	vector<int> order(m);
+	for (int i = 0; i < m; i++)
+		order[i] = i;
+	std::sort(order.begin(), order.end(), [&](int x, int y) { return costs[x] < costs[y]; });
+	ranks.assign(m, 0.0f);
+	for (int i = 0; i < m; )
+	{
+		int j = i;
+		while (j + 1 < m && costs[order[j + 1]] == costs[order[i]])
+			j++;
+		float rank = 0.5f * (i + j) + 1.0f;
+		for (int k = i; k <= j; k++)
+			ranks[order[k]] = rank;
+		i = j + 1;
+	}
+}
+
+/*******************************************************************************
+ * Eliminate - Friedman test followed by Conover post-hoc comparisons
+ *
+ * blockRanks[b][k] is the rank of alive[k] in block b. Returns the surviving
+ * subset of alive.
+ ******************************************************************************/
+vector<int> ParameterRace::Eliminate(const vector<int>& alive, const vector< vector<float> >& blockRanks)
+{
+	int n = (int)blockRanks.size();
+	int m = (int)alive.size();
+	if (m < 2 || n < 2)
+		return alive;
+
+	vector<double> rankSum(m, 0.0);
+	double sumSquares = 0.0;	// A: sum of all squared ranks
+	for (int b = 0; b < n; b++)
+	{
+		for (int k = 0; k < m; k++)
+		{
+			rankSum[k] += blockRanks[b][k];
+			sumSquares += blockRanks[b][k] * blockRanks[b][k];
+		}
+	}
+	double sumRankSq = 0.0;
+	for (int k = 0; k < m; k++)
+		sumRankSq += rankSum[k] * rankSum[k];
+
+	double c = n * m * (m + 1.0) * (m + 1.0) / 4.0;
+	if (sumSquares - c <= 0.0)
+		return alive;	// all configurations tied in every block
+	double t = (n - 1.0) * (sumRankSq - n * (m + 1.0) * (m + 1.0) * m / 4.0) / (sumSquares - c);
+	if (t <= ChiSquareQuantile(m - 1))
+		return alive;
+
+	int best = (int)(std::min_element(rankSum.begin(), rankSum.end()) - rankSum.begin());
+	double denom = sqrt(2.0 * (n * sumSquares - sumRankSq) / ((n - 1.0) * (m - 1.0)));
+	double critical = StudentTQuantile((n - 1) * (m - 1)) * denom;
+
+	vector<int> survivors;
+	for (int k = 0; k < m; k++)
+	{
+		if (k == best || rankSum[k] - rankSum[best] <= critical)
+			survivors.push_back(alive[k]);
+	}
+	return survivors;
+}
+
+TunedParameters ParameterRace::Race(const vector<const Board*>& instances, ostream& log)
+{
+	vector<TunedParameters> configs = SampleConfigurations();
+	vector<int> alive;
+	for (int i = 0; i < (int)configs.size(); i++)
+		alive.push_back(i);
+
+	// ranks per block, indexed by configuration (NAN once eliminated)
+	vector< vector<float> > ranksByConfig;
+	vector<float> costs, ranks;
+	int trials = 0;
+	int block = 0;
+	while (alive.size() > 1 && trials + (int)alive.size() <= settings.maxTrials)
+	{
+		const Board& puzzle = *instances[block % instances.size()];
+		RunBlock(configs, alive, puzzle, costs);
+		RankBlock(costs, ranks);
+		vector<float> row(configs.size(), NAN);
+		for (size_t k = 0; k < alive.size(); k++)
+			row[alive[k]] = ranks[k];
+		ranksByConfig.push_back(row);
+		trials += (int)alive.size();
+		block++;
+
+		if (block >= settings.minBlocks)
+		{
+			// ranks of the survivors, re-ranked over the blocks they all ran
+			vector< vector<float> > blockRanks;
+			for (size_t b = 0; b < ranksByConfig.size(); b++)
+			{
+				vector<float> blockCosts(alive.size());
+				for (size_t k = 0; k < alive.size(); k++)
+					blockCosts[k] = ranksByConfig[b][alive[k]];
+				vector<float> reranked;
+				RankBlock(blockCosts, reranked);
+				blockRanks.push_back(reranked);
+			}
+			size_t before = alive.size();
+			alive = Eliminate(alive, blockRanks);
+			if (alive.size() < before)
+				log << "  block " << block << ": " << before - alive.size() << " eliminated, " << alive.size() << " left" << endl;
+		}
+	}
+
+	// best surviving configuration by mean rank over all blocks it ran
+	int best = alive[0];
+	float bestMean = 1e30f;
+	for (int k : alive)
+	{
+		float total = 0.0f;
+		for (auto& row : ranksByConfig)
+			total += row[k];
+		float mean = total / ranksByConfig.size();
+		if (mean < bestMean)
+		{
+			bestMean = mean;
+			best = k;
+		}
+	}
+	log << "  " << block << " blocks, " << trials << " trials, best configuration " << best
+	    << (best == 0 ? " (defaults)" : "") << endl;
+	return configs[best];
+}
+
+bool WriteTunedConfig(const string& fileName, const map<int, TunedParameters>& results, const TunerSettings& settings)
+{
+	ofstream out(fileName);
+	if (!out.is_open())
+		return false;
+	out << "# parameters recommended by --tune (alg " << settings.alg << ", "
+	    << settings.trialTimeout << "s per trial); load with --config" << endl;
+	for (auto& r : results)
+	{
+		out << "[order" << r.first << "]" << endl;
+		out << "q0=" << r.second.q0 << endl;
+		out << "rho=" << r.second.rho << endl;
+		out << "evap=" << r.second.evap << endl;
+		out << "ants=" << r.second.ants << endl;
+		if (settings.alg == 2)
+			out << "subcolonies=" << r.second.subcolonies << endl;
+	}
+	return true;
+}
@@ -0,0 +1,73 @@
+#pragma once
+/*******************************************************************************
+ * PARAMETER TUNER - Racing of ACS parameter configurations (F-Race style)
+ *
+ * Candidate configurations (q0, rho, evap, ants, sub-colonies) are raced on a
+ * corpus of instances of one size class. Each block of the race runs every
+ * surviving configuration once on the next instance, with the trials of a
+ * block running in parallel threads of this process. The cost of a trial is
+ * its solution time, or twice the trial timeout on failure (PAR2).
+ *
+ * After a minimum number of blocks, a Friedman test on the per-block ranks
+ * decides whether the configurations differ; if they do, every configuration
+ * whose rank sum is significantly worse than the best (Conover post-hoc test)
+ * is eliminated. The race ends when one configuration is left or the trial
+ * budget is used up.
+ *
+ * Reference: Birattari et al. (2002) - A Racing Algorithm for Configuring
+ *            Metaheuristics
+ ******************************************************************************/
+
+#include "board.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <iostream>
+using namespace std;
+
+struct TunedParameters
+{
+	float q0;
+	float rho;
+	float evap;
+	int ants;
+	int subcolonies;
+};
+
+struct TunerSettings
+{
+	int alg;			// algorithm to tune (0 or 2)
+	int numConfigs;		// number of candidate configurations (including the defaults)
+	float trialTimeout;	// time limit per trial in seconds
+	int minBlocks;		// blocks before the first elimination test
+	int maxTrials;		// total trial budget per size class
+	int threads;		// parallel trials
+	unsigned seed;		// seed for sampling the configurations
+};
+
+class ParameterRace
+{
+	TunerSettings settings;
+	std::mt19937 randGen;
+
+	vector<TunedParameters> SampleConfigurations();
+	float RunTrial(const TunedParameters& params, const Board& puzzle);
+	void RunBlock(const vector<TunedParameters>& configs, const vector<int>& alive, const Board& puzzle, vector<float>& costs);
+	void RankBlock(const vector<float>& costs, vector<float>& ranks);
+	vector<int> Eliminate(const vector<int>& alive, const vector< vector<float> >& blockRanks);
+
+public:
+	ParameterRace(const TunerSettings& settings);
+
+	// Race the configurations on instances (all of the same order)
+	TunedParameters Race(const vector<const Board*>& instances, ostream& log);
+};
+
+/*******************************************************************************
+ * WriteTunedConfig
+ *
+ * Writes the recommended parameters per size class as a config file with one
+ * [orderN] section per class. The solver loads it with --config.
+ ******************************************************************************/
+bool WriteTunedConfig(const string& fileName, const map<int, TunedParameters>& results, const TunerSettings& settings);
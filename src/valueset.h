@@ -57,6 +57,7 @@ public:
 		mask = MASK0 >> (NBITS - nMax);
 	};
 
+	uint64_t GetBits() const { return bitmap; }
 	void Add(uint64_t v) { bitmap |= v; }
 	void Remove(uint64_t v) { bitmap &= (mask & ~v); }
 	